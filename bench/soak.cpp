@@ -0,0 +1,332 @@
+// Soak benchmark: many loops and bindings under a steady event rate.
+//
+//     soak --loops 1000 --bindings 4000 --rate 200000 --duration 300 --out soak.json
+//
+// Every binding is its own indexed route (connect_where on the event's key),
+// spread round robin over the loops; producer threads gen() to random keys
+// at a fixed total rate. The run goes through three phases:
+//   1. idle: loops running, nothing sent; measures CPU per idle loop;
+//   2. load: producers at --rate for --duration seconds, a report every
+//      --interval;
+//   3. teardown: producers stop, queues drain, loops are destroyed and every
+//      payload still alive is counted as leaked.
+//
+// Latency is measured from each event's scheduled send time to the start of
+// its handler, so a producer that falls behind shows up in the tail instead
+// of hiding it. Results go to stdout, or --out, as JSON lines: one
+// {"type":"interval"} record per report and a final {"type":"summary"}.
+// Progress goes to stderr. The exit status is 1 if a payload leaked or a
+// --max-* limit was exceeded, so a CI job can gate on it. Build with
+// -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <time.h>
+#include <unistd.h>
+
+#include "oska_epoll_loop.hpp"
+
+using namespace oska;
+
+namespace {
+
+struct Options {
+    size_t loops = 1000;
+    size_t bindings = 4000;
+    size_t producers = 4;
+    double rate = 100000;           // events per second, all producers together
+    double duration = 60;           // seconds under load
+    double interval = 5;            // seconds between reports
+    double idle = 5;                // seconds of idle measurement
+    size_t payload = 64;            // bytes of InlineString per event
+    std::string out;                // JSON lines; stdout if empty
+    double max_p99_us = 0;          // 0: no limit
+    double max_rss_growth_kb = 0;   // 0: no limit
+};
+
+struct alignas(64) CountShard {
+    std::atomic<int64_t> n{0};
+};
+
+// Live payload counter, sharded so producers and loops do not all hit one
+// cache line.
+class LiveCount {
+public:
+    static void add(int64_t n) {
+        thread_local size_t shard = next_shard_.fetch_add(1, std::memory_order_relaxed) % kShards;
+        shards_[shard].n.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    static int64_t total() {
+        int64_t sum = 0;
+        for (const auto& s : shards_) sum += s.n.load(std::memory_order_relaxed);
+        return sum;
+    }
+
+private:
+    static constexpr size_t kShards = 64;
+    static inline CountShard shards_[kShards];
+    static inline std::atomic<size_t> next_shard_{0};
+};
+
+// Carries the scheduled send time; every instance is counted while alive.
+struct Stamp {
+    uint64_t sent_ns = 0;
+
+    explicit Stamp(uint64_t ns) : sent_ns(ns) { LiveCount::add(1); }
+    Stamp(const Stamp& other) : sent_ns(other.sent_ns) { LiveCount::add(1); }
+    Stamp(Stamp&& other) noexcept : sent_ns(other.sent_ns) { LiveCount::add(1); }
+    Stamp& operator=(const Stamp&) = default;
+    ~Stamp() { LiveCount::add(-1); }
+};
+
+} // namespace
+
+OSKA_DEFINE_EVENT(EvSoak, uint32_t, Stamp, InlineString)   // key, send time, body
+
+namespace {
+
+struct alignas(64) LoopStats {
+    std::atomic<uint64_t> handled{0};
+    trace::Histogram latency;
+};
+
+uint64_t cpu_ns() {
+    timespec ts{};
+    ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint64_t rss_kb() {
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0, resident = 0;
+    statm >> size >> resident;
+    return resident * static_cast<uint64_t>(::sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+void sleep_s(double seconds) {
+    std::this_thread::sleep_for(std::chrono::nanoseconds(static_cast<int64_t>(seconds * 1e9)));
+}
+
+void usage(const char* argv0) {
+    std::cerr << "usage: " << argv0 << " [--loops N] [--bindings N] [--producers N] [--rate EV_PER_S]\n"
+              << "       [--duration S] [--interval S] [--idle S] [--payload BYTES] [--out FILE]\n"
+              << "       [--max-p99-us US] [--max-rss-growth-kb KB]\n";
+}
+
+bool parse(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string name = argv[i];
+        if (i + 1 >= argc) return false;
+        const char* value = argv[++i];
+        if (name == "--loops") opt.loops = std::strtoul(value, nullptr, 10);
+        else if (name == "--bindings") opt.bindings = std::strtoul(value, nullptr, 10);
+        else if (name == "--producers") opt.producers = std::strtoul(value, nullptr, 10);
+        else if (name == "--rate") opt.rate = std::strtod(value, nullptr);
+        else if (name == "--duration") opt.duration = std::strtod(value, nullptr);
+        else if (name == "--interval") opt.interval = std::strtod(value, nullptr);
+        else if (name == "--idle") opt.idle = std::strtod(value, nullptr);
+        else if (name == "--payload") opt.payload = std::strtoul(value, nullptr, 10);
+        else if (name == "--out") opt.out = value;
+        else if (name == "--max-p99-us") opt.max_p99_us = std::strtod(value, nullptr);
+        else if (name == "--max-rss-growth-kb") opt.max_rss_growth_kb = std::strtod(value, nullptr);
+        else return false;
+    }
+    return opt.loops > 0 && opt.bindings > 0 && opt.producers > 0 && opt.rate > 0 &&
+           opt.duration > 0 && opt.interval > 0;
+}
+
+double us(uint64_t ns) { return static_cast<double>(ns) / 1000.0; }
+
+std::string latency_json(const trace::Histogram& h) {
+    std::ostringstream os;
+    os << "\"p50_us\":" << us(h.percentile(50)) << ",\"p99_us\":" << us(h.percentile(99))
+       << ",\"p999_us\":" << us(h.percentile(99.9)) << ",\"max_us\":" << us(h.max())
+       << ",\"mean_us\":" << us(h.mean());
+    return os.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::ofstream file;
+    if (!opt.out.empty()) {
+        file.open(opt.out);
+        if (!file) {
+            std::cerr << "cannot open " << opt.out << "\n";
+            return 2;
+        }
+    }
+    std::ostream& json = opt.out.empty() ? std::cout : file;
+    int64_t live_before = LiveCount::total();
+
+    // ---- Setup ---- //
+    auto manager = std::make_unique<CormanManager>();
+    std::vector<std::unique_ptr<EpollEventLoop>> loops;
+    std::vector<std::unique_ptr<LoopStats>> stats;
+    std::vector<std::thread> loop_threads;
+    for (size_t i = 0; i < opt.loops; ++i) {
+        loops.push_back(std::make_unique<EpollEventLoop>("soak-" + std::to_string(i), *manager));
+        stats.push_back(std::make_unique<LoopStats>());
+    }
+    for (auto& loop : loops) loop_threads.emplace_back([&loop] { loop->run(); });
+
+    for (size_t key = 0; key < opt.bindings; ++key) {
+        size_t at = key % opt.loops;
+        LoopStats* s = stats[at].get();
+        manager->connect_where<EvSoak, 0>(static_cast<uint32_t>(key), loops[at].get(),
+                                          [s](uint32_t, const Stamp& stamp, InlineString) {
+            uint64_t now = trace::now_ns();
+            s->latency.record(now > stamp.sent_ns ? now - stamp.sent_ns : 0);
+            s->handled.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    std::cerr << "soak: " << opt.loops << " loops, " << opt.bindings << " bindings, "
+              << opt.producers << " producers at " << opt.rate << " ev/s\n";
+
+    // ---- Idle ---- //
+    double idle_cpu_pct = 0;
+    if (opt.idle > 0) {
+        uint64_t cpu0 = cpu_ns();
+        uint64_t wall0 = trace::now_ns();
+        sleep_s(opt.idle);
+        double cpu = static_cast<double>(cpu_ns() - cpu0);
+        double wall = static_cast<double>(trace::now_ns() - wall0);
+        idle_cpu_pct = cpu / wall / static_cast<double>(opt.loops) * 100.0;
+    }
+    uint64_t rss_idle = rss_kb();
+    std::cerr << "soak: idle cpu " << idle_cpu_pct << "% of a core per loop, rss " << rss_idle << " kB\n";
+
+    // ---- Load ---- //
+    std::atomic<bool> stop{false};
+    std::vector<std::atomic<uint64_t>> generated(opt.producers);
+    std::string body(opt.payload, 'x');
+    std::vector<std::thread> producers;
+    uint64_t load_start = trace::now_ns();
+    for (size_t p = 0; p < opt.producers; ++p) {
+        producers.emplace_back([&, p] {
+            double per_ns = opt.rate / static_cast<double>(opt.producers) / 1e9;
+            uint64_t rng = 0x9e3779b97f4a7c15ull * (p + 1);
+            uint64_t sent = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                uint64_t due = static_cast<uint64_t>(static_cast<double>(trace::now_ns() - load_start) * per_ns);
+                for (; sent < due && !stop.load(std::memory_order_relaxed); ++sent) {
+                    rng ^= rng << 13;
+                    rng ^= rng >> 7;
+                    rng ^= rng << 17;
+                    uint64_t scheduled = load_start + static_cast<uint64_t>(static_cast<double>(sent) / per_ns);
+                    manager->gen<EvSoak>(static_cast<uint32_t>(rng % opt.bindings), Stamp(scheduled), InlineString(body));
+                    generated[p].store(sent + 1, std::memory_order_relaxed);
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        });
+    }
+
+    auto handled_total = [&] {
+        uint64_t n = 0;
+        for (auto& s : stats) n += s->handled.load(std::memory_order_relaxed);
+        return n;
+    };
+    auto generated_total = [&] {
+        uint64_t n = 0;
+        for (auto& g : generated) n += g.load(std::memory_order_relaxed);
+        return n;
+    };
+
+    trace::Histogram total;
+    uint64_t rss_warm = 0;
+    uint64_t last_handled = 0;
+    uint64_t last_ns = load_start;
+    double elapsed = 0;
+    while (elapsed < opt.duration) {
+        sleep_s(std::min(opt.interval, opt.duration - elapsed));
+        uint64_t now = trace::now_ns();
+        elapsed = static_cast<double>(now - load_start) / 1e9;
+
+        trace::Histogram window;
+        for (auto& s : stats) s->latency.drain_into(window);
+        total.merge(window);
+
+        uint64_t handled = handled_total();
+        double rate = static_cast<double>(handled - last_handled) * 1e9 / static_cast<double>(now - last_ns);
+        uint64_t rss = rss_kb();
+        if (rss_warm == 0) rss_warm = rss;
+        int64_t in_flight = LiveCount::total() - live_before;
+
+        json << "{\"type\":\"interval\",\"t_s\":" << elapsed << ",\"handled\":" << handled
+             << ",\"rate\":" << rate << "," << latency_json(window) << ",\"rss_kb\":" << rss
+             << ",\"in_flight\":" << in_flight << "}" << std::endl;
+        std::cerr << "soak: t=" << elapsed << "s " << rate << " ev/s p99 " << us(window.percentile(99))
+                  << " us rss " << rss << " kB in flight " << in_flight << "\n";
+        last_handled = handled;
+        last_ns = now;
+    }
+
+    // ---- Teardown ---- //
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& t : producers) t.join();
+    uint64_t sent = generated_total();
+    uint64_t load_ns = trace::now_ns() - load_start;
+
+    auto drain_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (handled_total() < sent && std::chrono::steady_clock::now() < drain_deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    uint64_t handled = handled_total();
+    uint64_t rss_end = rss_kb();
+    for (auto& s : stats) total.merge(s->latency);
+
+    for (auto& loop : loops) loop->stop();
+    for (auto& t : loop_threads) t.join();
+    loops.clear();
+    manager.reset();
+    int64_t leaked = LiveCount::total() - live_before;
+
+    double sustained = static_cast<double>(handled) * 1e9 / static_cast<double>(load_ns);
+    double growth = static_cast<double>(rss_end) - static_cast<double>(rss_warm);
+    json << "{\"type\":\"summary\",\"loops\":" << opt.loops << ",\"bindings\":" << opt.bindings
+         << ",\"producers\":" << opt.producers << ",\"target_rate\":" << opt.rate
+         << ",\"duration_s\":" << static_cast<double>(load_ns) / 1e9 << ",\"payload_bytes\":" << opt.payload
+         << ",\"generated\":" << sent << ",\"handled\":" << handled << ",\"sustained_rate\":" << sustained
+         << "," << latency_json(total) << ",\"idle_cpu_pct_per_loop\":" << idle_cpu_pct
+         << ",\"rss_idle_kb\":" << rss_idle << ",\"rss_warm_kb\":" << rss_warm << ",\"rss_end_kb\":" << rss_end
+         << ",\"rss_growth_kb\":" << growth << ",\"leaked_payloads\":" << leaked << "}" << std::endl;
+
+    int status = 0;
+    if (leaked != 0) {
+        std::cerr << "soak: FAIL " << leaked << " payloads leaked\n";
+        status = 1;
+    }
+    if (handled != sent) {
+        std::cerr << "soak: FAIL " << sent - handled << " events not handled\n";
+        status = 1;
+    }
+    if (opt.max_p99_us > 0 && us(total.percentile(99)) > opt.max_p99_us) {
+        std::cerr << "soak: FAIL p99 " << us(total.percentile(99)) << " us over " << opt.max_p99_us << "\n";
+        status = 1;
+    }
+    if (opt.max_rss_growth_kb > 0 && growth > opt.max_rss_growth_kb) {
+        std::cerr << "soak: FAIL rss grew " << growth << " kB\n";
+        status = 1;
+    }
+    return status;
+}
@@ -0,0 +1,225 @@
+#ifndef BYTE_CHANNEL_H
+#define BYTE_CHANNEL_H
+
+// Single-producer single-consumer byte stream with zero-copy access.
+//
+// The ring is mapped twice, back to back, so every readable or writable
+// region is contiguous in memory even when it wraps. The producer reserve()s
+// a span, writes into it and commit()s; the consumer peek()s what is readable
+// and consume()s it when done:
+//
+//     ByteChannel ring(1 << 20);
+//     auto out = ring.reserve(len);          // producer thread
+//     encode(out.data, len);
+//     ring.commit(len);
+//
+//     auto in = ring.peek();                 // consumer thread
+//     size_t used = decode(in.data, in.size);
+//     ring.consume(used);
+//
+// Neither side ever copies the bytes. Capacity is rounded up to whole pages.
+// close() works like Channel::close: no more reservations, but what was
+// committed can still be read.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "channel.hpp"
+
+namespace oska
+{
+
+struct ByteSpan {
+    char* data = nullptr;
+    size_t size = 0;
+
+    explicit operator bool() const { return data != nullptr; }
+};
+
+class ByteChannel : public ChannelBase {
+public:
+    explicit ByteChannel(size_t capacity) {
+        size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        capacity_ = (capacity + page - 1) / page * page;
+        if (capacity_ == 0) capacity_ = page;
+        map_mirror();
+    }
+
+    ~ByteChannel() {
+        if (base_) ::munmap(base_, 2 * capacity_);
+    }
+
+    ByteChannel(const ByteChannel&) = delete;
+    ByteChannel& operator=(const ByteChannel&) = delete;
+
+    bool is_open() const { return base_ != nullptr; }
+    size_t capacity() const { return capacity_; }
+
+    // Bytes committed but not yet consumed.
+    size_t readable() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    // ---- Producer ---- //
+    // Waits for `n` free bytes. FULL if `n` exceeds the capacity, CLOSED once
+    // closed; the span is empty unless the result is OK.
+    ByteSpan reserve(size_t n, Result& result = dummy_result_) {
+        return reserver(n, true, result);
+    }
+
+    ByteSpan try_reserve(size_t n, Result& result = dummy_result_) {
+        return reserver(n, false, result);
+    }
+
+    // Publishes the first `n` bytes of the last reservation.
+    void commit(size_t n) {
+        head_.store(head_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+        wake(consumer_waiting_, consumer_cv_);
+    }
+
+    // ---- Consumer ---- //
+    // Waits until at least `min` bytes are readable and returns all of them.
+    // After close() the remaining bytes are returned even if fewer than
+    // `min`; CLOSED once nothing is left.
+    ByteSpan peek(size_t min = 1, Result& result = dummy_result_) {
+        return peeker(min, true, result);
+    }
+
+    ByteSpan try_peek(size_t min = 1, Result& result = dummy_result_) {
+        return peeker(min, false, result);
+    }
+
+    // Releases `n` bytes from the front of the last peek.
+    void consume(size_t n) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+        wake(producer_waiting_, producer_cv_);
+    }
+
+    void close() {
+        {
+            std::unique_lock<std::mutex> lock(sync_mutex_);
+            closed_ = true;
+            closing_.store(true, std::memory_order_seq_cst);
+        }
+        consumer_cv_.notify_all();
+        producer_cv_.notify_all();
+    }
+
+private:
+    // memfd mapped at [base, base + cap) and again at [base + cap, base + 2cap).
+    void map_mirror() {
+        int fd = ::memfd_create("oska-bytes", MFD_CLOEXEC);
+        if (fd < 0) return;
+        if (::ftruncate(fd, static_cast<off_t>(capacity_)) != 0) {
+            ::close(fd);
+            return;
+        }
+
+        void* area = ::mmap(nullptr, 2 * capacity_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (area == MAP_FAILED) {
+            ::close(fd);
+            return;
+        }
+
+        char* base = static_cast<char*>(area);
+        bool ok = ::mmap(base, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+                  ::mmap(base + capacity_, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+        ::close(fd);
+        if (!ok) {
+            ::munmap(area, 2 * capacity_);
+            return;
+        }
+        base_ = base;
+    }
+
+    void wake(std::atomic<bool>& waiting, std::condition_variable& cv) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed)) {
+            { std::unique_lock<std::mutex> lock(sync_mutex_); }
+            cv.notify_one();
+        }
+    }
+
+    ByteSpan reserver(size_t n, bool block, Result& result) {
+        if (!base_ || closing_.load(std::memory_order_acquire)) {
+            result = Result::CLOSED;
+            return {};
+        }
+        if (n > capacity_) {
+            result = Result::FULL;
+            return {};
+        }
+
+        auto fits = [&] { return capacity_ - readable() >= n; };
+        if (!fits()) {
+            if (!block) {
+                result = Result::FULL;
+                return {};
+            }
+            std::unique_lock<std::mutex> lock(sync_mutex_);
+            producer_waiting_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            producer_cv_.wait(lock, [&] { return closed_ || fits(); });
+            producer_waiting_.store(false, std::memory_order_relaxed);
+            if (closed_) {
+                result = Result::CLOSED;
+                return {};
+            }
+        }
+
+        result = Result::OK;
+        return {base_ + head_.load(std::memory_order_relaxed) % capacity_, n};
+    }
+
+    ByteSpan peeker(size_t min, bool block, Result& result) {
+        if (!base_) {
+            result = Result::CLOSED;
+            return {};
+        }
+        if (min == 0) min = 1;
+
+        auto ready = [&] { return readable() >= min || closing_.load(std::memory_order_seq_cst); };
+        if (!ready()) {
+            if (!block) {
+                result = Result::EMPTY;
+                return {};
+            }
+            std::unique_lock<std::mutex> lock(sync_mutex_);
+            consumer_waiting_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            consumer_cv_.wait(lock, ready);
+            consumer_waiting_.store(false, std::memory_order_relaxed);
+        }
+
+        size_t available = readable();
+        if (available == 0) {
+            result = Result::CLOSED;
+            return {};
+        }
+        if (available < min && !closing_.load(std::memory_order_acquire)) {
+            result = Result::EMPTY;
+            return {};
+        }
+        result = Result::OK;
+        return {base_ + tail_.load(std::memory_order_relaxed) % capacity_, available};
+    }
+
+    char* base_ = nullptr;
+    size_t capacity_ = 0;
+
+    alignas(64) std::atomic<uint64_t> head_{0};   // bytes committed
+    alignas(64) std::atomic<uint64_t> tail_{0};   // bytes consumed
+    alignas(64) std::atomic<bool> closing_{false};
+    std::atomic<bool> producer_waiting_{false};
+    std::atomic<bool> consumer_waiting_{false};
+};
+
+} // namespace oska
+
+#endif // BYTE_CHANNEL_H
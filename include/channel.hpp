@@ -6,19 +6,132 @@
 #include <condition_variable>
 #include <atomic>
 #include <memory>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+
+#include "oska_probes.hpp"
 
 namespace oska
 {
-    
+
+template <typename>
+inline constexpr bool dependent_false_v = false;
+
+// Wakes blocked channel operations without closing the channel. Pass the
+// same token to waits on any number of channels; cancel() makes every wait
+// that uses it, current or later, return CANCELLED until reset().
+class CancelToken {
+public:
+    CancelToken() = default;
+    CancelToken(const CancelToken&) = delete;
+    CancelToken& operator=(const CancelToken&) = delete;
+
+    void cancel() {
+        cancelled_.store(true, std::memory_order_seq_cst);
+        std::unique_lock<std::mutex> lock(mtx_);
+        for (const Waiter* waiter : waiters_) {
+            { std::unique_lock<std::mutex> wait_lock(*waiter->mtx); }
+            waiter->cv->notify_all();
+        }
+    }
+
+    void reset() { cancelled_.store(false, std::memory_order_seq_cst); }
+
+    bool cancelled() const { return cancelled_.load(std::memory_order_seq_cst); }
+
+private:
+    struct Waiter {
+        std::mutex* mtx;
+        std::condition_variable* cv;
+    };
+
+public:
+    // Lists a wait on `cv` (guarded by `mtx`) with the token for as long as
+    // it lives; a null token is a no-op. Create it before taking `mtx`, so
+    // cancel() never waits on a lock held by someone waiting for the token.
+    class Registration {
+    public:
+        Registration(CancelToken* token, std::mutex& mtx, std::condition_variable& cv)
+            : token_(token), waiter_{&mtx, &cv} {
+            if (!token_) return;
+            std::unique_lock<std::mutex> lock(token_->mtx_);
+            token_->waiters_.push_back(&waiter_);
+        }
+
+        ~Registration() {
+            if (!token_) return;
+            std::unique_lock<std::mutex> lock(token_->mtx_);
+            auto& waiters = token_->waiters_;
+            waiters.erase(std::find(waiters.begin(), waiters.end(), &waiter_));
+        }
+
+        Registration(const Registration&) = delete;
+        Registration& operator=(const Registration&) = delete;
+
+    private:
+        CancelToken* token_;
+        Waiter waiter_;
+    };
+
+private:
+
+    std::atomic<bool> cancelled_{false};
+    std::mutex mtx_;              // taken before any channel mutex, never after
+    std::vector<const Waiter*> waiters_;
+};
+
 class ChannelBase {
 public:
     enum class Result {
         OK,
         CLOSED,
         FULL,
-        EMPTY
+        EMPTY,
+        TIMEOUT,     // *_for / *_until ran out of time
+        CANCELLED    // the operation's CancelToken fired
     };
 protected:
+    // Identifies the channel in probes.
+    const void* channel_id() const { return this; }
+
+    // Locks sync_mutex_. With probes compiled in, finding it held fires
+    // channel__contended before blocking.
+    std::unique_lock<std::mutex> lock_sync() {
+#ifdef OSKA_USDT
+        std::unique_lock<std::mutex> lock(sync_mutex_, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            OSKA_PROBE1(channel__contended, channel_id());
+            lock.lock();
+        }
+        return lock;
+#else
+        return std::unique_lock<std::mutex>(sync_mutex_);
+#endif
+    }
+
+    // cv.wait() for `ready`, bounded by `deadline` and `token` when given.
+    // A wait that became ready is OK even if it also timed out or was
+    // cancelled.
+    template <typename TimePoint, typename Pred>
+    Result await(std::unique_lock<std::mutex>& lock, std::condition_variable& cv,
+                 const TimePoint* deadline, const CancelToken* token, Pred ready) {
+        auto done = [&] { return ready() || (token && token->cancelled()); };
+        if (!done()) {
+            [[maybe_unused]] int side = &cv == &producer_cv_ ? 1 : 0;
+            OSKA_PROBE2(channel__wait__start, channel_id(), side);
+            if (deadline) {
+                cv.wait_until(lock, *deadline, done);
+            } else {
+                cv.wait(lock, done);
+            }
+            OSKA_PROBE3(channel__wait__end, channel_id(), side, static_cast<int>(ready()));
+        }
+        if (ready()) return Result::OK;
+        return token && token->cancelled() ? Result::CANCELLED : Result::TIMEOUT;
+    }
+
     std::mutex sync_mutex_;
     bool closed_ = false;
     std::condition_variable consumer_cv_;
@@ -27,9 +140,99 @@ protected:
     inline static Result dummy_result_;
 };
 
+// Timed and cancellable forms of add() and get(), mixed into both Channel
+// flavours. `Derived` befriends it and provides adder() and getter() that
+// take a deadline and a token. The *_for forms measure from the call on the
+// steady clock.
+template <typename Derived, typename Type>
+class ChannelTimedOps {
+    using Result = ChannelBase::Result;
+    using Deadline = std::chrono::steady_clock::time_point;
+    using Registration = CancelToken::Registration;
+
+public:
+    template <typename U>
+    Result add(U&& var, CancelToken& token) {
+        return timed_add(std::forward<U>(var), static_cast<const Deadline*>(nullptr), &token);
+    }
+
+    template <typename U, typename Rep, typename Period>
+    Result add_for(U&& var, const std::chrono::duration<Rep, Period>& timeout) {
+        Deadline deadline = std::chrono::steady_clock::now() + timeout;
+        return timed_add(std::forward<U>(var), &deadline, nullptr);
+    }
+
+    template <typename U, typename Rep, typename Period>
+    Result add_for(U&& var, const std::chrono::duration<Rep, Period>& timeout, CancelToken& token) {
+        Deadline deadline = std::chrono::steady_clock::now() + timeout;
+        return timed_add(std::forward<U>(var), &deadline, &token);
+    }
+
+    template <typename U, typename Clock, typename Duration>
+    Result add_until(U&& var, const std::chrono::time_point<Clock, Duration>& deadline) {
+        return timed_add(std::forward<U>(var), &deadline, nullptr);
+    }
+
+    template <typename U, typename Clock, typename Duration>
+    Result add_until(U&& var, const std::chrono::time_point<Clock, Duration>& deadline, CancelToken& token) {
+        return timed_add(std::forward<U>(var), &deadline, &token);
+    }
+
+    std::unique_ptr<Type> get(CancelToken& token, Result& result = dummy_result_) {
+        return timed_get(static_cast<const Deadline*>(nullptr), &token, result);
+    }
+
+    template <typename Rep, typename Period>
+    std::unique_ptr<Type> get_for(const std::chrono::duration<Rep, Period>& timeout, Result& result = dummy_result_) {
+        Deadline deadline = std::chrono::steady_clock::now() + timeout;
+        return timed_get(&deadline, nullptr, result);
+    }
+
+    template <typename Rep, typename Period>
+    std::unique_ptr<Type> get_for(const std::chrono::duration<Rep, Period>& timeout, CancelToken& token,
+                                  Result& result = dummy_result_) {
+        Deadline deadline = std::chrono::steady_clock::now() + timeout;
+        return timed_get(&deadline, &token, result);
+    }
+
+    template <typename Clock, typename Duration>
+    std::unique_ptr<Type> get_until(const std::chrono::time_point<Clock, Duration>& deadline,
+                                    Result& result = dummy_result_) {
+        return timed_get(&deadline, nullptr, result);
+    }
+
+    template <typename Clock, typename Duration>
+    std::unique_ptr<Type> get_until(const std::chrono::time_point<Clock, Duration>& deadline, CancelToken& token,
+                                    Result& result = dummy_result_) {
+        return timed_get(&deadline, &token, result);
+    }
+
+private:
+    template <typename U, typename TimePoint>
+    Result timed_add(U&& var, const TimePoint* deadline, CancelToken* token) {
+        Derived& self = static_cast<Derived&>(*this);
+        Registration registration(token, self.sync_mutex_, self.producer_cv_);
+        std::unique_lock<std::mutex> lock = self.lock_sync();
+        return self.adder(std::forward<U>(var), std::move(lock), deadline, token);
+    }
+
+    template <typename TimePoint>
+    std::unique_ptr<Type> timed_get(const TimePoint* deadline, CancelToken* token, Result& result) {
+        Derived& self = static_cast<Derived&>(*this);
+        Registration registration(token, self.sync_mutex_, self.consumer_cv_);
+        std::unique_lock<std::mutex> lock = self.lock_sync();
+        return self.getter(std::move(lock), result, deadline, token);
+    }
+
+    inline static Result dummy_result_;
+};
+
 // Channel class template
 template <typename Type, size_t N>
-class Channel : public ChannelBase {
+class Channel : public ChannelBase, public ChannelTimedOps<Channel<Type, N>, Type> {
+    friend class ChannelTimedOps<Channel<Type, N>, Type>;
+    using Deadline = std::chrono::steady_clock::time_point;
+
     std::unique_ptr<Type> array[N];
     std::atomic<size_t> head_ = 0;
     std::atomic<size_t> tail_ = 0;
@@ -42,19 +245,26 @@ class Channel : public ChannelBase {
         return array[tail_] == nullptr;
     }
 
+    // Items queued; for probes.
+    size_t depth() const {
+        return is_full() ? N : (head_ + N - tail_) % N;
+    }
+
     bool toBeClosed_ = false;
 
 public:
+    using ChannelTimedOps<Channel<Type, N>, Type>::add;
+    using ChannelTimedOps<Channel<Type, N>, Type>::get;
 
     template <typename U>
     Result add(U&& var) {
-        std::unique_lock<std::mutex> lock(sync_mutex_);
+        std::unique_lock<std::mutex> lock = lock_sync();
         return adder(std::forward<U>(var), std::move(lock));
     }
 
     template <typename U>
     Result try_add(U&& var) {
-        std::unique_lock<std::mutex> lock(sync_mutex_);
+        std::unique_lock<std::mutex> lock = lock_sync();
         if (closed_) {
             return Result::CLOSED; // Channel is closed
         } else if (is_full()) {
@@ -63,13 +273,32 @@ public:
         return adder(std::forward<U>(var), std::move(lock));
     }
 
+    // Queues an already allocated item without copying or allocating. The
+    // item is only moved from on OK. Returns EMPTY for a null item.
+    Result add_ptr(std::unique_ptr<Type>&& item) {
+        if (!item) return Result::EMPTY;
+        std::unique_lock<std::mutex> lock = lock_sync();
+        return storer(std::move(lock), [&item] { return std::move(item); });
+    }
+
+    Result try_add_ptr(std::unique_ptr<Type>&& item) {
+        if (!item) return Result::EMPTY;
+        std::unique_lock<std::mutex> lock = lock_sync();
+        if (closed_) {
+            return Result::CLOSED; // Channel is closed
+        } else if (is_full()) {
+            return Result::FULL; // Channel is full
+        }
+        return storer(std::move(lock), [&item] { return std::move(item); });
+    }
+
     std::unique_ptr<Type> get(Result& result = dummy_result_) {
-        std::unique_lock<std::mutex> lock(sync_mutex_);
+        std::unique_lock<std::mutex> lock = lock_sync();
         return getter(std::move(lock), result);
     }
 
     std::unique_ptr<Type> try_get(Result& result = dummy_result_) {
-        std::unique_lock<std::mutex> lock(sync_mutex_);
+        std::unique_lock<std::mutex> lock = lock_sync();
         if (closed_) {
             result = Result::CLOSED; // Channel is closed
             return nullptr; // Channel is closed
@@ -81,9 +310,10 @@ public:
     }
 
     void close() {
-        std::unique_lock<std::mutex> lock(sync_mutex_);
+        std::unique_lock<std::mutex> lock = lock_sync();
         toBeClosed_ = true;
-        
+        OSKA_PROBE1(channel__close, channel_id());
+
         if (is_empty()) {
             closed_ = true;
         }
@@ -94,10 +324,16 @@ public:
         producer_cv_.notify_all();
     }
 private:
-    std::unique_ptr<Type> getter(std::unique_lock<std::mutex> lock, Result& result) {
+    template <typename TimePoint = Deadline>
+    std::unique_ptr<Type> getter(std::unique_lock<std::mutex> lock, Result& result,
+                                 const TimePoint* deadline = nullptr, const CancelToken* token = nullptr) {
         std::unique_ptr<Type> item = nullptr;
 
-        consumer_cv_.wait(lock, [this] { return closed_ || !is_empty(); });
+        Result waited = await(lock, consumer_cv_, deadline, token, [this] { return closed_ || !is_empty(); });
+        if (waited != Result::OK) {
+            result = waited;
+            return nullptr;
+        }
 
         if (!closed_) {
             size_t tail_current = tail_;
@@ -111,6 +347,7 @@ private:
             }
 
             item = std::move(array[tail_current]);
+            OSKA_PROBE2(channel__get, channel_id(), depth());
 
             lock.unlock(); // Unlock the mutex before notifying 
 
@@ -124,10 +361,29 @@ private:
         return item;
     }
 
-    template <typename U>
-    Result adder(U&& var, std::unique_lock<std::mutex> lock) {
-        producer_cv_.wait(lock, [this] { return closed_ || toBeClosed_ || !is_full(); });
-        
+    template <typename U, typename TimePoint = Deadline>
+    Result adder(U&& var, std::unique_lock<std::mutex> lock,
+                 const TimePoint* deadline = nullptr, const CancelToken* token = nullptr) {
+        return storer(std::move(lock), [&var] {
+            if constexpr (std::is_move_constructible_v<Type>) {
+                return std::make_unique<Type>(std::forward<U>(var));
+            } else if constexpr (std::is_copy_constructible_v<Type>) {
+                return std::make_unique<Type>(var);
+            } else {
+                static_assert(dependent_false_v<Type>, "Type is neither move nor copy constructible");
+                return std::unique_ptr<Type>();
+            }
+        }, deadline, token);
+    }
+
+    // `make` produces the slot's item once there is room and the channel is open.
+    template <typename Make, typename TimePoint = Deadline>
+    Result storer(std::unique_lock<std::mutex> lock, Make&& make,
+                  const TimePoint* deadline = nullptr, const CancelToken* token = nullptr) {
+        Result waited = await(lock, producer_cv_, deadline, token,
+                              [this] { return closed_ || toBeClosed_ || !is_full(); });
+        if (waited != Result::OK) return waited;
+
         size_t head_local = head_;
         head_ = (head_ + 1) % N;
 
@@ -135,15 +391,9 @@ private:
             return Result::CLOSED;
         }
 
-        if constexpr (std::is_move_constructible_v<Type>) {
-            array[head_local] = std::make_unique<Type>(std::forward<U>(var));
-        } else if constexpr (std::is_copy_constructible_v<Type>) {
-            array[head_local] = std::make_unique<Type>(var);
-        } else {
-            array[head_local] = nullptr; // Clear the slot
-            static_assert(false, "Type is neither move nor copy constructible");
-        }
-        
+        array[head_local] = make();
+        OSKA_PROBE2(channel__add, channel_id(), depth());
+
         lock.unlock(); // Unlock the mutex before notifying
         
         consumer_cv_.notify_one();
@@ -155,17 +405,23 @@ private:
 
 
 template <typename Type>
-class Channel<Type, 0> : public ChannelBase {
+class Channel<Type, 0> : public ChannelBase, public ChannelTimedOps<Channel<Type, 0>, Type> {
+    friend class ChannelTimedOps<Channel<Type, 0>, Type>;
+    using Deadline = std::chrono::steady_clock::time_point;
+
 public:
+    using ChannelTimedOps<Channel<Type, 0>, Type>::add;
+    using ChannelTimedOps<Channel<Type, 0>, Type>::get;
+
     template <typename U>
     Result add(U&& var) {
-        std::unique_lock<std::mutex> lock(sync_mutex_);
+        std::unique_lock<std::mutex> lock = lock_sync();
         return adder(std::forward<U>(var), std::move(lock));
     }
 
     template <typename U>
     Result try_add(U&& var) {
-        std::unique_lock<std::mutex> lock(sync_mutex_);
+        std::unique_lock<std::mutex> lock = lock_sync();
         if (closed_) {
             return Result::CLOSED;  // Channel is closed
         } else if (consumer_waiting_ == 0) {
@@ -174,16 +430,33 @@ public:
         return adder(std::forward<U>(var), std::move(lock));
     }
 
+    Result add_ptr(std::unique_ptr<Type>&& item) {
+        if (!item) return Result::EMPTY;
+        std::unique_lock<std::mutex> lock = lock_sync();
+        return storer(std::move(lock), [&item] { return std::move(item); });
+    }
+
+    Result try_add_ptr(std::unique_ptr<Type>&& item) {
+        if (!item) return Result::EMPTY;
+        std::unique_lock<std::mutex> lock = lock_sync();
+        if (closed_) {
+            return Result::CLOSED;  // Channel is closed
+        } else if (consumer_waiting_ == 0) {
+            return Result::FULL;  // no consumer waiting
+        }
+        return storer(std::move(lock), [&item] { return std::move(item); });
+    }
+
 
     std::unique_ptr<Type> get(Result& result = dummy_result_) {
-        std::unique_lock<std::mutex> lock(sync_mutex_);
+        std::unique_lock<std::mutex> lock = lock_sync();
 
         return getter(std::move(lock), result);
     }
 
 
     std::unique_ptr<Type> try_get(Result& result = dummy_result_) {
-        std::unique_lock<std::mutex> lock(sync_mutex_);
+        std::unique_lock<std::mutex> lock = lock_sync();
         if (closed_) {
             result = Result::CLOSED;  // Channel is closed
             return nullptr;  // Channel is closed
@@ -196,9 +469,10 @@ public:
 
 
 void close() {
-    std::unique_lock<std::mutex> lock(sync_mutex_);
+    std::unique_lock<std::mutex> lock = lock_sync();
 
     closed_ = true;
+    OSKA_PROBE1(channel__close, channel_id());
 
     lock.unlock(); // Unlock the mutex before notifying
     
@@ -208,22 +482,29 @@ void close() {
 
 private:
 
-    std::unique_ptr<Type> getter(std::unique_lock<std::mutex> lock, Result& result) {
+    template <typename TimePoint = Deadline>
+    std::unique_ptr<Type> getter(std::unique_lock<std::mutex> lock, Result& result,
+                                 const TimePoint* deadline = nullptr, const CancelToken* token = nullptr) {
         consumer_waiting_++;
 
         // Notify producers we're ready
         producer_cv_.notify_one();
 
         // Wait until producer sends
-        consumer_cv_.wait(lock, [this] { return closed_ || handoff_; });
+        Result waited = await(lock, consumer_cv_, deadline, token, [this] { return closed_ || handoff_; });
 
         consumer_waiting_--;
+        if (waited != Result::OK) {
+            result = waited;
+            return nullptr;
+        }
 
         std::unique_ptr<Type> item = nullptr;
         if (handoff_) {
             item = std::move(handoff_);
             handoff_ = nullptr; // Clear the handoff
             result = Result::OK;
+            OSKA_PROBE2(channel__get, channel_id(), static_cast<size_t>(0));
         } else {
             item = nullptr;  // Channel closed
             result = Result::CLOSED;
@@ -236,27 +517,42 @@ private:
         return item;
     }
 
-    template <typename U>
-    Result adder(U&& var, std::unique_lock<std::mutex> lock) {
+    template <typename U, typename TimePoint = Deadline>
+    Result adder(U&& var, std::unique_lock<std::mutex> lock,
+                 const TimePoint* deadline = nullptr, const CancelToken* token = nullptr) {
+        return storer(std::move(lock), [&var] {
+            if constexpr (std::is_move_constructible_v<Type>) {
+                return std::make_unique<Type>(std::forward<U>(var));
+            } else if constexpr (std::is_copy_constructible_v<Type>) {
+                return std::make_unique<Type>(var);
+            } else {
+                static_assert(dependent_false_v<Type>, "Type is neither move nor copy constructible");
+                return std::unique_ptr<Type>();
+            }
+        }, deadline, token);
+    }
+
+    template <typename Make, typename TimePoint = Deadline>
+    Result storer(std::unique_lock<std::mutex> lock, Make&& make,
+                  const TimePoint* deadline = nullptr, const CancelToken* token = nullptr) {
 
         producer_waiting_++;
 
         // Wait until consumer is waiting
-        producer_cv_.wait(lock, [this] { return closed_ || (consumer_waiting_ > 0 && !handoff_); });
+        Result waited = await(lock, producer_cv_, deadline, token,
+                              [this] { return closed_ || (consumer_waiting_ > 0 && !handoff_); });
+        if (waited != Result::OK) {
+            producer_waiting_--;
+            return waited;
+        }
 
         if (closed_) {
             return Result::CLOSED;
         }
 
-        if constexpr (std::is_move_constructible_v<Type>) {
-            handoff_ = std::make_unique<Type>(std::forward<U>(var));
-        } else if constexpr (std::is_copy_constructible_v<Type>) {
-            handoff_ = std::make_unique<Type>(var);
-        } else {
-            handoff_ = nullptr; // Clear the handoff
-            static_assert(false, "Type is neither move nor copy constructible");
-        }
+        handoff_ = make();
         producer_waiting_--;
+        OSKA_PROBE2(channel__add, channel_id(), static_cast<size_t>(1));
 
         lock.unlock(); // Unlock the mutex before notifying
         
@@ -270,6 +566,182 @@ private:
     std::atomic<size_t> consumer_waiting_ = 0;
 };
 
+// RecyclingChannel: Channel plus a bounded freelist running the other way.
+// Producers acquire() an object (recycled if one is available), fill it and
+// add_ptr() it; consumers hand finished objects back with recycle(). Once the
+// pool is warm a pipeline of large payloads allocates nothing, provided PoolN
+// covers the ring plus every object producers and consumers hold at once.
+template <typename Type, size_t N, size_t PoolN = 2 * N + 2>
+class RecyclingChannel : public Channel<Type, N> {
+public:
+    struct Stats {
+        size_t reused;      // acquire() served from the pool
+        size_t allocated;   // acquire() had to allocate
+        size_t recycled;    // recycle() kept the object
+        size_t discarded;   // recycle() found the pool full
+    };
+
+    // Recycled objects come back in whatever state the consumer left them;
+    // `args` are only used when a new object has to be constructed.
+    template <typename... Args>
+    std::unique_ptr<Type> acquire(Args&&... args) {
+        {
+            std::unique_lock<std::mutex> lock(pool_mutex_);
+            if (pool_size_ > 0) {
+                reused_.fetch_add(1, std::memory_order_relaxed);
+                return std::move(pool_[--pool_size_]);
+            }
+        }
+        allocated_.fetch_add(1, std::memory_order_relaxed);
+        return std::make_unique<Type>(std::forward<Args>(args)...);
+    }
+
+    void recycle(std::unique_ptr<Type> item) {
+        if (!item) return;
+        std::unique_lock<std::mutex> lock(pool_mutex_);
+        if (pool_size_ < PoolN) {
+            pool_[pool_size_++] = std::move(item);
+            recycled_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        lock.unlock();
+        discarded_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Stats stats() const {
+        return {reused_.load(std::memory_order_relaxed), allocated_.load(std::memory_order_relaxed),
+                recycled_.load(std::memory_order_relaxed), discarded_.load(std::memory_order_relaxed)};
+    }
+
+    size_t pooled() {
+        std::unique_lock<std::mutex> lock(pool_mutex_);
+        return pool_size_;
+    }
+
+private:
+    std::mutex pool_mutex_;
+    std::unique_ptr<Type> pool_[PoolN];
+    size_t pool_size_ = 0;
+
+    std::atomic<size_t> reused_ = 0;
+    std::atomic<size_t> allocated_ = 0;
+    std::atomic<size_t> recycled_ = 0;
+    std::atomic<size_t> discarded_ = 0;
+};
+
+// OverwriteChannel: Channel with an overwrite-on-full policy, for feeds where
+// stale data is worth less than a stalled producer (telemetry, logging).
+// add() never waits: on a full ring it drops the oldest unread item and
+// counts an overrun. Every item carries a sequence number, so a consumer
+// that sees a gap knows how many items it missed.
+template <typename Type, size_t N>
+class OverwriteChannel : public ChannelBase {
+    static_assert(N > 0, "OverwriteChannel has no unbuffered form");
+
+public:
+    // Never FULL; CLOSED once closed.
+    template <typename U>
+    Result add(U&& var) {
+        if constexpr (std::is_move_constructible_v<Type>) {
+            return add_ptr(std::make_unique<Type>(std::forward<U>(var)));
+        } else if constexpr (std::is_copy_constructible_v<Type>) {
+            return add_ptr(std::make_unique<Type>(var));
+        } else {
+            static_assert(dependent_false_v<Type>, "Type is neither move nor copy constructible");
+            return Result::CLOSED;
+        }
+    }
+
+    template <typename U>
+    Result try_add(U&& var) {
+        return add(std::forward<U>(var));
+    }
+
+    Result add_ptr(std::unique_ptr<Type>&& item) {
+        if (!item) return Result::EMPTY;
+        std::unique_ptr<Type> dropped;
+        {
+            std::unique_lock<std::mutex> lock(sync_mutex_);
+            if (closed_ || toBeClosed_) return Result::CLOSED;
+            if (head_ - tail_ == N) {
+                dropped = std::move(array[tail_ % N]);   // destroyed outside the lock
+                tail_++;
+                overruns_.fetch_add(1, std::memory_order_relaxed);
+            }
+            array[head_ % N] = std::move(item);
+            head_++;
+        }
+        consumer_cv_.notify_one();
+        return Result::OK;
+    }
+
+    Result try_add_ptr(std::unique_ptr<Type>&& item) {
+        return add_ptr(std::move(item));
+    }
+
+    std::unique_ptr<Type> get(Result& result = dummy_result_) {
+        uint64_t seq;
+        return get(result, seq);
+    }
+
+    // `seq` is the item's sequence number; seq - (previous seq + 1) items
+    // were overwritten before this consumer got to them.
+    std::unique_ptr<Type> get(Result& result, uint64_t& seq) {
+        std::unique_lock<std::mutex> lock(sync_mutex_);
+        consumer_cv_.wait(lock, [this] { return closed_ || head_ != tail_; });
+        return getter(result, seq);
+    }
+
+    std::unique_ptr<Type> try_get(Result& result = dummy_result_) {
+        uint64_t seq;
+        return try_get(result, seq);
+    }
+
+    std::unique_ptr<Type> try_get(Result& result, uint64_t& seq) {
+        std::unique_lock<std::mutex> lock(sync_mutex_);
+        if (!closed_ && head_ == tail_) {
+            result = Result::EMPTY;
+            return nullptr;
+        }
+        return getter(result, seq);
+    }
+
+    void close() {
+        {
+            std::unique_lock<std::mutex> lock(sync_mutex_);
+            toBeClosed_ = true;
+            if (head_ == tail_) closed_ = true;
+        }
+        consumer_cv_.notify_all();
+    }
+
+    // Items dropped to make room since construction.
+    uint64_t overruns() const { return overruns_.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<Type> getter(Result& result, uint64_t& seq) {
+        if (closed_) {
+            result = Result::CLOSED;
+            return nullptr;
+        }
+        seq = tail_;
+        std::unique_ptr<Type> item = std::move(array[tail_ % N]);
+        tail_++;
+        if (toBeClosed_ && head_ == tail_) {
+            closed_ = true;
+            consumer_cv_.notify_all();
+        }
+        result = Result::OK;
+        return item;
+    }
+
+    std::unique_ptr<Type> array[N];
+    uint64_t head_ = 0;   // sequence number of the next item added
+    uint64_t tail_ = 0;   // sequence number of the oldest unread item
+    bool toBeClosed_ = false;
+    std::atomic<uint64_t> overruns_ = 0;
+};
+
 } // namespace oska
 
 #endif // CHANNEL_H
@@ -0,0 +1,248 @@
+#ifndef COMPACT_CHANNEL_H
+#define COMPACT_CHANNEL_H
+
+// Channel for topologies with very many mostly idle channels (one per
+// session, per connection, ...).
+//
+// A CompactChannel holds no mutex, no condition variables and no storage
+// until it is used:
+//   - the ring is allocated on the first add(), starting small and doubling
+//     up to N slots as the backlog grows;
+//   - trim() frees it again once the channel has been empty for `idle`
+//     (call it from a periodic sweep over the channels);
+//   - blocking goes through a process-wide ParkingLot: a fixed table of
+//     mutex/condition variable buckets picked by the channel's address. The
+//     bucket mutex also guards the channel's state.
+//
+// An idle channel is about 40 bytes. add/get/try_add/try_get/add_ptr/close
+// behave like Channel<Type, N>; channels that share a bucket share its lock,
+// so a few very hot channels are better served by Channel or ShardedChannel.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+#include "channel.hpp"
+
+namespace oska
+{
+
+class ParkingLot {
+public:
+    static constexpr size_t kBuckets = 512;
+
+    struct alignas(64) Bucket {
+        std::mutex mtx;
+        std::condition_variable cv;
+        size_t waiters = 0;     // under mtx
+
+        // Waits on the shared condition variable until `ready()`.
+        template <typename Pred>
+        void park(std::unique_lock<std::mutex>& lock, Pred ready) {
+            waiters++;
+            cv.wait(lock, ready);
+            waiters--;
+        }
+
+        // Called with mtx held. Every channel in the bucket shares `cv`, so
+        // all waiters wake and recheck.
+        void unpark() {
+            if (waiters) cv.notify_all();
+        }
+    };
+
+    static Bucket& bucket(const void* key) {
+        static Bucket buckets[kBuckets];
+        size_t h = std::hash<const void*>()(key);
+        h ^= h >> 17;
+        return buckets[(h >> 4) % kBuckets];
+    }
+};
+
+template <typename Type, size_t N>
+class CompactChannel {
+    static_assert(N > 0, "CompactChannel has no unbuffered form");
+    static_assert(N <= UINT32_MAX, "CompactChannel capacity must fit 32 bits");
+
+public:
+    using Result = ChannelBase::Result;
+
+    static constexpr uint32_t kInitialSlots = N < 4 ? static_cast<uint32_t>(N) : 4;
+
+    explicit CompactChannel(std::chrono::milliseconds idle = std::chrono::seconds(1))
+        : idle_ms_(static_cast<uint32_t>(idle.count())) {}
+
+    ~CompactChannel() { release(); }
+
+    CompactChannel(const CompactChannel&) = delete;
+    CompactChannel& operator=(const CompactChannel&) = delete;
+
+    template <typename U>
+    Result add(U&& var) {
+        return adder(std::forward<U>(var), true);
+    }
+
+    template <typename U>
+    Result try_add(U&& var) {
+        return adder(std::forward<U>(var), false);
+    }
+
+    Result add_ptr(std::unique_ptr<Type>&& item) {
+        if (!item) return Result::EMPTY;
+        return storer([&item] { return item.release(); }, true);
+    }
+
+    Result try_add_ptr(std::unique_ptr<Type>&& item) {
+        if (!item) return Result::EMPTY;
+        return storer([&item] { return item.release(); }, false);
+    }
+
+    std::unique_ptr<Type> get(Result& result = dummy_result_) {
+        return getter(result, true);
+    }
+
+    std::unique_ptr<Type> try_get(Result& result = dummy_result_) {
+        return getter(result, false);
+    }
+
+    void close() {
+        ParkingLot::Bucket& bucket = ParkingLot::bucket(this);
+        std::unique_lock<std::mutex> lock(bucket.mtx);
+        closed_ = true;
+        bucket.unpark();
+    }
+
+    // Frees the ring if the channel has been empty for at least `idle`.
+    // Returns true if it did.
+    bool trim(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now()) {
+        ParkingLot::Bucket& bucket = ParkingLot::bucket(this);
+        Type** ring = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(bucket.mtx);
+            if (!ring_ || count_ != 0) return false;
+            if (ns(now) - empty_since_ns_ < static_cast<uint64_t>(idle_ms_) * 1000000) return false;
+            ring = ring_;
+            ring_ = nullptr;
+            cap_ = 0;
+            head_ = 0;
+        }
+        delete[] ring;
+        return true;
+    }
+
+    // Slots currently allocated; 0 while idle.
+    size_t allocated() {
+        std::unique_lock<std::mutex> lock(ParkingLot::bucket(this).mtx);
+        return cap_;
+    }
+
+    size_t size() {
+        std::unique_lock<std::mutex> lock(ParkingLot::bucket(this).mtx);
+        return count_;
+    }
+
+private:
+    static uint64_t ns(std::chrono::steady_clock::time_point t) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count());
+    }
+
+    // Makes room for one more item if the ring can still grow; called with
+    // the bucket mutex held.
+    bool reserve_slot() {
+        if (count_ < cap_) return true;
+        if (cap_ == N) return false;
+
+        uint32_t cap = cap_ ? cap_ * 2 : kInitialSlots;
+        if (cap > N) cap = static_cast<uint32_t>(N);
+        Type** ring = new Type*[cap];
+        for (uint32_t i = 0; i < count_; ++i) ring[i] = ring_[(head_ + i) % cap_];
+        delete[] ring_;
+        ring_ = ring;
+        cap_ = cap;
+        head_ = 0;
+        return true;
+    }
+
+    template <typename U>
+    Result adder(U&& var, bool block) {
+        auto make = [&var] {
+            if constexpr (std::is_move_constructible_v<Type>) {
+                return new Type(std::forward<U>(var));
+            } else if constexpr (std::is_copy_constructible_v<Type>) {
+                return new Type(var);
+            } else {
+                static_assert(dependent_false_v<Type>, "Type is neither move nor copy constructible");
+                return static_cast<Type*>(nullptr);
+            }
+        };
+        return storer(make, block);
+    }
+
+    // `make` runs once a slot is reserved, so nothing is moved from on failure.
+    template <typename Make>
+    Result storer(Make make, bool block) {
+        ParkingLot::Bucket& bucket = ParkingLot::bucket(this);
+        std::unique_lock<std::mutex> lock(bucket.mtx);
+        if (!closed_ && !reserve_slot()) {
+            if (!block) return Result::FULL;
+            bucket.park(lock, [this] { return closed_ || reserve_slot(); });
+        }
+        if (closed_) return Result::CLOSED;
+
+        ring_[(head_ + count_) % cap_] = make();
+        count_++;
+        bucket.unpark();
+        return Result::OK;
+    }
+
+    std::unique_ptr<Type> getter(Result& result, bool block) {
+        ParkingLot::Bucket& bucket = ParkingLot::bucket(this);
+        std::unique_lock<std::mutex> lock(bucket.mtx);
+        if (count_ == 0 && !closed_) {
+            if (!block) {
+                result = Result::EMPTY;
+                return nullptr;
+            }
+            bucket.park(lock, [this] { return closed_ || count_ != 0; });
+        }
+        if (count_ == 0) {
+            result = Result::CLOSED;
+            return nullptr;
+        }
+
+        std::unique_ptr<Type> item(ring_[head_]);
+        head_ = (head_ + 1) % cap_;
+        count_--;
+        if (count_ == 0) empty_since_ns_ = ns(std::chrono::steady_clock::now());
+        bucket.unpark();
+        result = Result::OK;
+        return item;
+    }
+
+    void release() {
+        for (uint32_t i = 0; i < count_; ++i) delete ring_[(head_ + i) % cap_];
+        delete[] ring_;
+        ring_ = nullptr;
+        count_ = 0;
+        cap_ = 0;
+    }
+
+    Type** ring_ = nullptr;
+    uint64_t empty_since_ns_ = 0;
+    uint32_t head_ = 0;
+    uint32_t count_ = 0;
+    uint32_t cap_ = 0;
+    uint32_t idle_ms_;
+    bool closed_ = false;
+
+    inline static Result dummy_result_;
+};
+
+} // namespace oska
+
+#endif // COMPACT_CHANNEL_H
@@ -0,0 +1,348 @@
+#ifndef OSKA_ACTOR_HPP
+#define OSKA_ACTOR_HPP
+
+// Actors: many small entities that each handle their own events one at a
+// time, run by a fixed pool of worker threads.
+//
+//     struct Session : Actor { int seen = 0; };
+//
+//     ActorSystem actors;                               // one worker per core
+//     actors.connect<EvPacket, Session>([](Session& s, int len) { s.seen += len; });
+//
+//     std::vector<Session> sessions(1000000);
+//     actors.gen<EvPacket>(sessions[42], 1500);
+//
+// An actor is only its mailbox (an intrusive lock-free stack of messages)
+// and a run queue link, 32 bytes on 64-bit targets; it has no thread, lock
+// or loop of its own. Sending to an idle actor puts it on the run queue, a
+// worker then handles up to `quantum` of its messages before moving on to
+// the next runnable actor, so a flooded actor cannot starve the others.
+// Messages to one actor are handled in the order each sender sent them and
+// never concurrently.
+//
+// Handlers are bound per actor type and event, with the same EventTraits
+// events CormanManager uses; a handler may gen() to other actors or to
+// event loops. Actors must outlive the messages sent to them: destroy them
+// after the system has stopped, or once wait_idle() returned and nothing
+// sends to them any more. Unhandled messages are freed with the actor.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "oska_events.hpp"
+
+namespace oska {
+
+class Actor;
+
+// Header of every message; the payload follows in a derived struct.
+struct ActorMessage {
+    ActorMessage* next = nullptr;
+    void (*run)(ActorMessage* self, Actor* to);   // handles and frees; frees only if `to` is null
+};
+
+class Actor {
+public:
+    Actor() = default;
+
+    ~Actor() {
+        drop(next_);
+        drop(inbox_.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    Actor(const Actor&) = delete;
+    Actor& operator=(const Actor&) = delete;
+
+private:
+    friend class ActorSystem;
+
+    static void drop(ActorMessage* m) {
+        while (m) {
+            ActorMessage* next = m->next;
+            m->run(m, nullptr);
+            m = next;
+        }
+    }
+
+    // Senders push onto inbox_ (newest first); the worker running the actor
+    // takes it whole and keeps it in next_, oldest first.
+    std::atomic<ActorMessage*> inbox_{nullptr};
+    ActorMessage* next_ = nullptr;
+    Actor* next_runnable_ = nullptr;           // run queue link, under ActorSystem::mtx_
+    std::atomic<bool> scheduled_{false};       // on the run queue or running
+};
+
+// ---- Type Traits for Actor Handlers ---- //
+template<typename A, typename Tuple, typename F>
+struct is_actor_handler;
+
+template<typename A, typename... Args, typename F>
+struct is_actor_handler<A, std::tuple<Args...>, F> {
+    static constexpr bool value = std::is_invocable_v<F&, A&, Args&...>;
+};
+
+class ActorSystem {
+public:
+    struct Options {
+        size_t workers = 0;     // 0: one per hardware thread
+        size_t quantum = 32;    // messages per actor before the next one runs
+    };
+
+    ActorSystem() : ActorSystem(Options()) {}
+
+    explicit ActorSystem(Options options)
+        : quantum_(options.quantum ? options.quantum : 1), epoch_(next_epoch()) {
+        size_t workers = options.workers;
+        if (workers == 0) workers = std::thread::hardware_concurrency();
+        if (workers == 0) workers = 1;
+        for (size_t i = 0; i < workers; ++i) threads_.emplace_back([this] { work(); });
+    }
+
+    // Stops the workers once nothing is runnable.
+    ~ActorSystem() { stop(); }
+
+    ActorSystem(const ActorSystem&) = delete;
+    ActorSystem& operator=(const ActorSystem&) = delete;
+
+    // ---- Handlers ---- //
+    // `handler(A&, args...)` runs for every EventTag message sent to an
+    // actor of type A. Binding again replaces it for messages sent from then
+    // on.
+    template<typename EventTag, typename A, typename Func>
+    void connect(Func handler) {
+        using ExpectedArgs = typename EventTraits<EventTag>::Args;
+        static_assert(std::is_base_of_v<Actor, A>, "Actor types must derive from oska::Actor");
+        static_assert(!is_query_event<EventTag>::value, "Actors do not answer query events");
+        static_assert(is_actor_handler<A, ExpectedArgs, Func>::value,
+                      "Handler is not callable with the actor and arguments from EventTraits");
+
+        auto bound = std::make_unique<Handler<A, EventTag>>();
+        bound->fn = [handler](A& self, ExpectedArgs& args) mutable {
+            std::apply([&](auto&... a) { handler(self, a...); }, args);
+        };
+
+        std::unique_lock<std::mutex> lock(handlers_mtx_);
+        handlers_[{TypeId<A>::value(), TypeId<EventTag>::value()}] = bound.get();
+        owned_.push_back(std::move(bound));    // messages in flight may still point at older ones
+        epoch_.store(next_epoch(), std::memory_order_release);
+    }
+
+    // ---- Sending ---- //
+    // Queues an EventTag message for `to`. Returns false, and drops the
+    // message, if no handler is bound for A and EventTag.
+    template<typename EventTag, typename A, typename... PassedArgs>
+    bool gen(A& to, PassedArgs&&... args) {
+        using ExpectedArgs = typename EventTraits<EventTag>::Args;
+        using ProvidedArgs = std::tuple<std::decay_t<PassedArgs>...>;
+        static_assert(std::is_base_of_v<Actor, A>, "Actor types must derive from oska::Actor");
+        static_assert(std::is_same<ProvidedArgs, ExpectedArgs>::value,
+                      "Argument types do not match EventTraits");
+
+        const Handler<A, EventTag>* handler = handler_for<A, EventTag>();
+        if (!handler) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        size_t extra = (size_t(0) + ... + inline_arg_size(args));
+        auto* m = new_payload<Envelope<A, EventTag>>(extra, handler, ExpectedArgs{std::forward<PassedArgs>(args)...});
+        deliver(to, m);
+        return true;
+    }
+
+    // ---- Running ---- //
+    // Blocks until no actor is runnable or running.
+    void wait_idle() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        idle_cv_.wait(lock, [this] { return active_ == 0; });
+    }
+
+    // Lets the workers finish every runnable actor, then joins them.
+    // Messages sent afterwards stay in their mailboxes.
+    void stop() {
+        std::vector<std::thread> threads;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            stop_ = true;
+            threads.swap(threads_);
+        }
+        cv_.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    // Messages dropped by gen() for want of a handler.
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct HandlerBase {
+        virtual ~HandlerBase() = default;
+    };
+
+    template<typename A, typename EventTag>
+    struct Handler : HandlerBase {
+        std::function<void(A&, typename EventTraits<EventTag>::Args&)> fn;
+    };
+
+    template<typename A, typename EventTag>
+    struct Envelope : ActorMessage {
+        using Args = typename EventTraits<EventTag>::Args;
+
+        Envelope(const Handler<A, EventTag>* h, Args&& a) : handler(h), args(std::move(a)) {
+            run = &Envelope::handle;
+        }
+
+        static void handle(ActorMessage* self, Actor* to) {
+            auto* m = static_cast<Envelope*>(self);
+            if (to) m->handler->fn(static_cast<A&>(*to), m->args);
+            delete_payload(m);
+        }
+
+        const Handler<A, EventTag>* handler;
+        Args args;
+    };
+
+    // Epochs are unique across systems, so a thread's cached handler never
+    // matches a different system that reuses this one's address.
+    static uint64_t next_epoch() {
+        static std::atomic<uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // Thread-local handler cache per actor type and event; skips
+    // handlers_mtx_ until the next connect().
+    template<typename A, typename EventTag>
+    const Handler<A, EventTag>* handler_for() {
+        struct Cached {
+            const ActorSystem* system = nullptr;
+            uint64_t epoch = 0;
+            const Handler<A, EventTag>* handler = nullptr;
+        };
+        static thread_local Cached cached;
+
+        uint64_t now = epoch_.load(std::memory_order_acquire);
+        if (cached.system != this || cached.epoch != now) {
+            std::unique_lock<std::mutex> lock(handlers_mtx_);
+            auto it = handlers_.find({TypeId<A>::value(), TypeId<EventTag>::value()});
+            cached.handler = it == handlers_.end() ? nullptr : static_cast<const Handler<A, EventTag>*>(it->second);
+            cached.system = this;
+            cached.epoch = epoch_.load(std::memory_order_relaxed);
+        }
+        return cached.handler;
+    }
+
+    void deliver(Actor& to, ActorMessage* m) {
+        m->next = to.inbox_.load(std::memory_order_relaxed);
+        while (!to.inbox_.compare_exchange_weak(m->next, m, std::memory_order_seq_cst, std::memory_order_relaxed)) {}
+        if (!to.scheduled_.exchange(true, std::memory_order_seq_cst)) schedule(&to);
+    }
+
+    // Takes an actor that was not scheduled onto the run queue. Once
+    // stopped, no worker would ever run it: its messages stay in the
+    // mailbox and it is not counted as active.
+    void schedule(Actor* actor) {
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            if (stop_) {
+                actor->scheduled_.store(false, std::memory_order_relaxed);
+                return;
+            }
+            active_++;
+            enqueue(actor);
+        }
+        cv_.notify_one();
+    }
+
+    // Called with mtx_ held.
+    void enqueue(Actor* actor) {
+        actor->next_runnable_ = nullptr;
+        if (tail_) {
+            tail_->next_runnable_ = actor;
+        } else {
+            head_ = actor;
+        }
+        tail_ = actor;
+    }
+
+    void work() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        for (;;) {
+            cv_.wait(lock, [this] { return stop_ || head_; });
+            if (!head_) return;
+
+            Actor* actor = head_;
+            head_ = actor->next_runnable_;
+            if (!head_) tail_ = nullptr;
+
+            lock.unlock();
+            bool again = run(*actor);
+            lock.lock();
+
+            if (again) {
+                enqueue(actor);
+            } else if (--active_ == 0) {
+                idle_cv_.notify_all();
+            }
+        }
+    }
+
+    // Handles up to quantum_ messages. Returns true if the actor stays
+    // scheduled and goes to the back of the run queue.
+    bool run(Actor& actor) {
+        for (size_t n = 0; n < quantum_; ++n) {
+            if (!actor.next_) actor.next_ = reverse(actor.inbox_.exchange(nullptr, std::memory_order_acquire));
+            ActorMessage* m = actor.next_;
+            if (!m) break;
+            actor.next_ = m->next;
+            m->run(m, &actor);
+            CormanManager::flush();
+        }
+        if (actor.next_ || actor.inbox_.load(std::memory_order_acquire)) return true;
+
+        // A sender that pushes after this sees scheduled_ false and
+        // schedules the actor itself; one that pushed before is seen here.
+        actor.scheduled_.store(false, std::memory_order_seq_cst);
+        if (!actor.inbox_.load(std::memory_order_seq_cst)) return false;
+        return !actor.scheduled_.exchange(true, std::memory_order_seq_cst);
+    }
+
+    static ActorMessage* reverse(ActorMessage* m) {
+        ActorMessage* out = nullptr;
+        while (m) {
+            ActorMessage* next = m->next;
+            m->next = out;
+            out = m;
+            m = next;
+        }
+        return out;
+    }
+
+    const size_t quantum_;
+
+    std::mutex handlers_mtx_;
+    std::map<std::pair<size_t, size_t>, const HandlerBase*> handlers_;   // (actor type, event)
+    std::vector<std::unique_ptr<HandlerBase>> owned_;
+    std::atomic<uint64_t> epoch_;
+    std::atomic<uint64_t> dropped_{0};
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    Actor* head_ = nullptr;                 // run queue
+    Actor* tail_ = nullptr;
+    size_t active_ = 0;                     // actors scheduled or running
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace oska
+
+#endif // OSKA_ACTOR_HPP
@@ -0,0 +1,178 @@
+#ifndef OSKA_BALANCER_HPP
+#define OSKA_BALANCER_HPP
+
+// Moves hot event tags between loops based on measured handler time.
+//
+// Every round the balancer looks at how much handler time each tag used since
+// the last round (CormanManager::loads(), with load tracking switched on) and
+// what each loop still has queued. If the busiest loop carries more than
+// `imbalance` times the load of the idlest one, one of its tags is migrated
+// there with CormanManager::migrate(), which keeps the tag's event order:
+//
+//     LoadBalancer balancer(Corman, {&io0, &io1, &io2});
+//     balancer.start();                 // a round every `interval`
+//     ...
+//     balancer.stop();
+//
+// Only tags bound to one of the balanced loops are moved, one migration at a
+// time, and a loop's last tag stays where it is. The loops must accept tasks
+// (EpollEventLoop, PriorityEventLoop).
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "oska_events.hpp"
+
+namespace oska {
+
+class LoadBalancer {
+public:
+    struct Options {
+        double imbalance = 1.5;                   // busiest / idlest before acting
+        uint64_t min_busy_ns = 1000000;           // per round; below this nothing moves
+        std::chrono::milliseconds interval{100};  // between rounds with start()
+    };
+
+    LoadBalancer(CormanManager& manager, std::vector<EventLoopInterface*> loops)
+        : LoadBalancer(manager, std::move(loops), Options()) {}
+
+    LoadBalancer(CormanManager& manager, std::vector<EventLoopInterface*> loops, Options options)
+        : manager_(manager), loops_(std::move(loops)), options_(options) {
+        manager_.set_load_tracking(true);
+    }
+
+    ~LoadBalancer() { stop(); }
+
+    LoadBalancer(const LoadBalancer&) = delete;
+    LoadBalancer& operator=(const LoadBalancer&) = delete;
+
+    // One round. True if it started a migration.
+    bool rebalance() {
+        std::unique_lock<std::mutex> lock(round_mtx_);
+        std::vector<CormanManager::TagLoad> now = manager_.loads();
+
+        struct LoopLoad {
+            uint64_t busy_ns = 0;
+            uint64_t handled = 0;
+            std::vector<std::pair<size_t, uint64_t>> tags;   // tag, busy_ns this round
+        };
+        std::vector<LoopLoad> per_loop(loops_.size());
+
+        for (const auto& load : now) {
+            Sample& last = last_[load.tag];
+            uint64_t busy = load.busy_ns - std::min(last.busy_ns, load.busy_ns);
+            uint64_t handled = load.handled - std::min(last.handled, load.handled);
+            last = Sample{load.busy_ns, load.handled};
+
+            auto it = std::find(loops_.begin(), loops_.end(), load.target);
+            if (it == loops_.end()) continue;
+            LoopLoad& l = per_loop[static_cast<size_t>(it - loops_.begin())];
+            l.busy_ns += busy;
+            l.handled += handled;
+            l.tags.emplace_back(load.tag, busy);
+        }
+
+        if (pending_.valid() && !pending_.ready()) return false;
+        pending_ = Future<bool>();
+        if (loops_.size() < 2) return false;
+
+        // What is still queued counts at this round's average cost per event.
+        std::vector<uint64_t> total(loops_.size());
+        for (size_t i = 0; i < loops_.size(); ++i) {
+            const LoopLoad& l = per_loop[i];
+            uint64_t queued = loops_[i]->backlog();
+            uint64_t cost = l.handled ? l.busy_ns / l.handled : 0;
+            total[i] = l.busy_ns + queued * cost;
+        }
+
+        size_t hot = static_cast<size_t>(std::max_element(total.begin(), total.end()) - total.begin());
+        size_t cold = static_cast<size_t>(std::min_element(total.begin(), total.end()) - total.begin());
+        if (hot == cold || per_loop[hot].tags.size() < 2) return false;
+        if (total[hot] < options_.min_busy_ns) return false;
+        if (static_cast<double>(total[hot]) < options_.imbalance * static_cast<double>(total[cold])) return false;
+
+        // The tag whose move leaves the two loops closest to even.
+        uint64_t gap = total[hot] - total[cold];
+        size_t best = 0;
+        uint64_t best_left = gap;
+        bool found = false;
+        for (const auto& tag : per_loop[hot].tags) {
+            if (tag.second == 0 || tag.second >= gap) continue;
+            uint64_t twice = 2 * tag.second;
+            uint64_t left = twice > gap ? twice - gap : gap - twice;
+            if (left < best_left) {
+                best_left = left;
+                best = tag.first;
+                found = true;
+            }
+        }
+        if (!found) return false;
+
+        pending_ = manager_.migrate(best, loops_[cold]);
+        migrations_++;
+        return true;
+    }
+
+    // Runs rebalance() every `interval` on its own thread.
+    void start() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (thread_.joinable()) return;
+        stop_ = false;
+        thread_ = std::thread([this] {
+            std::unique_lock<std::mutex> lock(mtx_);
+            while (!cv_.wait_for(lock, options_.interval, [this] { return stop_; })) {
+                lock.unlock();
+                rebalance();
+                lock.lock();
+            }
+        });
+    }
+
+    // Joins the thread; a migration already started still completes.
+    void stop() {
+        std::thread thread;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            stop_ = true;
+            thread.swap(thread_);
+        }
+        cv_.notify_all();
+        if (thread.joinable()) thread.join();
+    }
+
+    // Migrations started so far.
+    uint64_t migrations() const {
+        std::unique_lock<std::mutex> lock(round_mtx_);
+        return migrations_;
+    }
+
+private:
+    struct Sample {
+        uint64_t busy_ns = 0;
+        uint64_t handled = 0;
+    };
+
+    CormanManager& manager_;
+    std::vector<EventLoopInterface*> loops_;
+    Options options_;
+
+    mutable std::mutex round_mtx_;
+    std::unordered_map<size_t, Sample> last_;
+    Future<bool> pending_;
+    uint64_t migrations_ = 0;
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::thread thread_;
+    bool stop_ = false;
+};
+
+} // namespace oska
+
+#endif // OSKA_BALANCER_HPP
@@ -0,0 +1,360 @@
+#ifndef OSKA_EPOLL_LOOP_HPP
+#define OSKA_EPOLL_LOOP_HPP
+
+// EventLoop that waits on file descriptors and oska events together.
+//
+// Posted events are queued in memory; an eventfd only wakes the loop when the
+// queue goes from empty to non-empty, so a burst costs one write. Readiness on
+// watched descriptors is turned into a typed event through CormanManager:
+//
+//     OSKA_DEFINE_EVENT(EvSocketReady, int, uint32_t)   // fd, epoll events
+//     Corman.connect<EvSocketReady>(&loop, on_ready);
+//     loop.watch<EvSocketReady>(sock, EPOLLIN);
+//
+// When the event is bound to this same loop, its handler runs in the same
+// iteration that saw the readiness.
+//
+// An optional Placement pins the thread that calls run() and keeps the event
+// queues on the placement's NUMA node. They are then reserved once at
+// kPlacedReserve events; a larger burst still grows them, one mapping per
+// doubling.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "oska_events.hpp"
+#include "oska_topology.hpp"
+
+namespace oska {
+
+class EpollEventLoop : public EventLoopInterface {
+public:
+    using FdArgs = std::tuple<int, uint32_t>;
+    using TimerArgs = std::tuple<uint64_t>;
+
+    static constexpr int kMaxEvents = 64;
+    static constexpr size_t kMaxRun = 256;      // events per batch handler call
+    static constexpr size_t kPlacedReserve = 1024;  // queue capacity on a NUMA node
+
+    explicit EpollEventLoop(const std::string& name = "epoll", CormanManager& manager = Corman,
+                            Placement placement = Placement())
+        : tracer(name), manager_(manager), placement_(placement),
+          pending_(Alloc(topo::node_for(placement))),
+          batch_(pending_.get_allocator()),
+          local_(pending_.get_allocator()),
+          local_batch_(pending_.get_allocator()) {
+        size_t reserve = pending_.get_allocator().node() < 0 ? kMaxEvents : kPlacedReserve;
+        pending_.reserve(reserve);
+        batch_.reserve(reserve);
+        local_.reserve(reserve);
+        local_batch_.reserve(reserve);
+
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = wake_fd_;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+    }
+
+    // Events still queued (posted after run() returned, or to a loop that
+    // never ran) are discarded, so their payloads are freed.
+    ~EpollEventLoop() {
+        for (const auto& ev : pending_) discard_event(ev);
+        for (const auto& ev : local_) discard_event(ev);
+        for (auto& entry : watches_) {
+            if (entry.second.owned) ::close(entry.first);
+        }
+        ::close(wake_fd_);
+        ::close(epoll_fd_);
+    }
+
+    EpollEventLoop(const EpollEventLoop&) = delete;
+    EpollEventLoop& operator=(const EpollEventLoop&) = delete;
+
+    bool is_open() const { return epoll_fd_ >= 0 && wake_fd_ >= 0; }
+
+    // ---- EventLoopInterface ---- //
+    void post(size_t tag, void* data) override {
+        post(EventWrapper(tag, data));
+    }
+
+    void post(const EventWrapper& ev) override {
+        bool was_empty;
+        {
+            std::unique_lock<std::mutex> lock(queue_mtx_);
+            was_empty = pending_.empty();
+            pending_.push_back(ev);
+        }
+        if (was_empty) wake();
+    }
+
+    void post_batch(const EventWrapper* evs, size_t count) override {
+        bool was_empty;
+        {
+            std::unique_lock<std::mutex> lock(queue_mtx_);
+            was_empty = pending_.empty();
+            pending_.insert(pending_.end(), evs, evs + count);
+        }
+        if (was_empty && count) wake();
+    }
+
+    // Owner-thread queue, drained before the loop goes back to epoll_wait.
+    bool post_local(const EventWrapper& ev) override {
+        local_.push_back(ev);
+        return true;
+    }
+
+    void run_inline(const EventWrapper& ev, const Callback& cb) override {
+        HandlerProbe probe(this, ev.tag, 0, ev.data);
+        trace::HandlerScope scope(tracer, ev);
+        cb(ev.data);
+    }
+
+    void connect(size_t tag, Callback cb) override {
+        callbacks[tag] = cb;
+        batch_callbacks.erase(tag);
+    }
+
+    void disconnect(size_t tag) override {
+        callbacks.erase(tag);
+        batch_callbacks.erase(tag);
+    }
+
+    bool connect_batch(size_t tag, BatchCallback cb) override {
+        batch_callbacks[tag] = cb;
+        return true;
+    }
+
+    bool accepts_tasks() const override { return true; }
+
+    size_t backlog() override {
+        std::unique_lock<std::mutex> lock(queue_mtx_);
+        return pending_.size();
+    }
+
+    void run() override {
+        RunScope scope(this);
+        topo::apply(placement_);
+        epoll_event ready[kMaxEvents];
+
+        while (!stop_.load(std::memory_order_acquire)) {
+            int n = ::epoll_wait(epoll_fd_, ready, kMaxEvents, -1);
+            for (int i = 0; i < n; ++i) {
+                if (ready[i].data.fd == wake_fd_) {
+                    uint64_t count;
+                    while (::read(wake_fd_, &count, sizeof(count)) > 0) {
+                    }
+                } else {
+                    on_ready(ready[i].data.fd, ready[i].events);
+                }
+            }
+            drain();
+        }
+        drain();
+    }
+
+    // Thread safe; run() returns after finishing what is already queued.
+    void stop() {
+        stop_.store(true, std::memory_order_release);
+        wake();
+    }
+
+    // ---- Descriptor watches ---- //
+    // `EventTag` must carry (int fd, uint32_t epoll_events). Level triggered
+    // unless EPOLLET is passed, so the handler is expected to consume the fd.
+    template<typename EventTag>
+    bool watch(int fd, uint32_t events) {
+        static_assert(std::is_same_v<typename EventTraits<EventTag>::Args, FdArgs>,
+                      "Watch events must carry (int fd, uint32_t events)");
+        CormanManager* manager = &manager_;
+        return add_watch(fd, events, false, [manager, fd](uint32_t ready) {
+            manager->gen<EventTag>(fd, ready);
+        });
+    }
+
+    // Periodic timer backed by a timerfd owned by the loop. `EventTag` carries
+    // the number of expirations since the last delivery. Returns the timerfd,
+    // or -1 on failure.
+    template<typename EventTag>
+    int add_timer(std::chrono::nanoseconds interval, std::chrono::nanoseconds first = std::chrono::nanoseconds(0)) {
+        static_assert(std::is_same_v<typename EventTraits<EventTag>::Args, TimerArgs>,
+                      "Timer events must carry (uint64_t expirations)");
+
+        int fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (fd < 0) return -1;
+
+        if (first.count() == 0) first = interval;
+        itimerspec spec{};
+        spec.it_interval.tv_sec = interval.count() / 1000000000;
+        spec.it_interval.tv_nsec = interval.count() % 1000000000;
+        spec.it_value.tv_sec = first.count() / 1000000000;
+        spec.it_value.tv_nsec = first.count() % 1000000000;
+        ::timerfd_settime(fd, 0, &spec, nullptr);
+
+        CormanManager* manager = &manager_;
+        if (!add_watch(fd, EPOLLIN, true, [manager, fd](uint32_t) {
+                uint64_t expirations = 0;
+                if (::read(fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+                    manager->gen<EventTag>(expirations);
+                }
+            })) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // Stops watching; timers created by add_timer() are closed too.
+    bool unwatch(int fd) {
+        std::unique_lock<std::mutex> lock(watch_mtx_);
+        auto it = watches_.find(fd);
+        if (it == watches_.end()) return false;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        if (it->second.owned) ::close(fd);
+        watches_.erase(it);
+        return true;
+    }
+
+    trace::LoopTracer tracer;
+
+private:
+    using Alloc = topo::NodeAllocator<EventWrapper>;
+    using Queue = std::vector<EventWrapper, Alloc>;
+
+    struct Watch {
+        std::function<void(uint32_t)> fire;
+        bool owned;
+    };
+
+    bool add_watch(int fd, uint32_t events, bool owned, std::function<void(uint32_t)> fire) {
+        std::unique_lock<std::mutex> lock(watch_mtx_);
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) return false;
+        watches_[fd] = Watch{std::move(fire), owned};
+        return true;
+    }
+
+    void on_ready(int fd, uint32_t events) {
+        std::function<void(uint32_t)> fire;
+        {
+            std::unique_lock<std::mutex> lock(watch_mtx_);
+            auto it = watches_.find(fd);
+            if (it == watches_.end()) return;
+            fire = it->second.fire;
+        }
+        fire(events);
+    }
+
+    void wake() {
+        uint64_t one = 1;
+        if (::write(wake_fd_, &one, sizeof(one)) < 0) {
+            // Counter saturated; the loop is awake anyway.
+        }
+    }
+
+    void drain() {
+        {
+            std::unique_lock<std::mutex> lock(queue_mtx_);
+            batch_.swap(pending_);
+        }
+        for (size_t i = 0; i < batch_.size();) {
+            i += handle_run(i);
+            drain_local();
+        }
+        batch_.clear();
+        drain_local();
+    }
+
+    void drain_local() {
+        while (!local_.empty()) {
+            local_batch_.swap(local_);
+            for (size_t i = 0; i < local_batch_.size(); ++i) handle(local_batch_[i], local_batch_.size() - i - 1);
+            local_batch_.clear();
+        }
+    }
+
+    // Handles batch_[i] and, if its tag has a batch handler, the events of
+    // the same tag right behind it. Returns how many were consumed.
+    size_t handle_run(size_t i) {
+        const EventWrapper& first = batch_[i];
+        auto it = batch_callbacks.empty() ? batch_callbacks.end() : batch_callbacks.find(first.tag);
+        if (it == batch_callbacks.end()) {
+            handle(first, batch_.size() - i - 1);
+            return 1;
+        }
+
+        size_t end = i;
+        run_data_.clear();
+        while (end < batch_.size() && batch_[end].tag == first.tag && end - i < kMaxRun) {
+            run_data_.push_back(batch_[end].data);
+            end++;
+        }
+        {
+            HandlerProbe probe(this, first.tag, batch_.size() - end, first.data);
+            trace::HandlerScope scope(tracer, first);
+            it->second(run_data_.data(), run_data_.size());
+        }
+        CormanManager::flush();
+        return end - i;
+    }
+
+    // `depth`: events queued behind this one in the current drain. Events
+    // whose tag has no handler are discarded.
+    void handle(const EventWrapper& ev, size_t depth) {
+        if (run_task(ev)) {
+            CormanManager::flush();
+            return;
+        }
+        auto it = callbacks.find(ev.tag);
+        if (it == callbacks.end()) {
+            discard_event(ev);
+        } else {
+            {
+                HandlerProbe probe(this, ev.tag, depth, ev.data);
+                trace::HandlerScope scope(tracer, ev);
+                it->second(ev.data);
+            }
+            CormanManager::flush();
+        }
+    }
+
+    CormanManager& manager_;
+    Placement placement_;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::atomic<bool> stop_{false};
+
+    Queue pending_;
+    Queue batch_;                            // loop thread only
+    std::mutex queue_mtx_;
+
+    Queue local_;                            // loop thread only
+    Queue local_batch_;
+
+    std::unordered_map<int, Watch> watches_;
+    std::mutex watch_mtx_;
+
+    std::unordered_map<size_t, Callback> callbacks;
+    std::unordered_map<size_t, BatchCallback> batch_callbacks;
+    std::vector<void*> run_data_;            // loop thread only
+};
+
+} // namespace oska
+
+#endif // OSKA_EPOLL_LOOP_HPP
@@ -9,6 +9,21 @@
 #include <typeindex>
 #include <type_traits>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#if __has_include(<span>)
+#include <span>
+#endif
+
+#include "oska_future.hpp"
+#include "oska_probes.hpp"
+#include "oska_trace.hpp"
 
 namespace oska {
 
@@ -31,19 +46,307 @@ struct EventTraits;
     struct name {};                                        \
     template<> struct oska::EventTraits<name> {            \
         using Args = std::tuple<__VA_ARGS__>;              \
+        static constexpr const char* name_str = #name;     \
+    };
+
+// Same as OSKA_DEFINE_EVENT, with an oska::Priority for loops that have lanes.
+#define OSKA_DEFINE_PRIORITY_EVENT(name, prio, ...)        \
+    struct name {};                                        \
+    template<> struct oska::EventTraits<name> {            \
+        using Args = std::tuple<__VA_ARGS__>;              \
+        static constexpr const char* name_str = #name;     \
+        static constexpr oska::Priority priority = prio;   \
+    };
+
+// Query event: handlers return `result`, which Corman.call<name>() delivers
+// through a Future. gen() on a query event discards the reply.
+#define OSKA_DEFINE_QUERY_EVENT(name, result, ...)         \
+    struct name {};                                        \
+    template<> struct oska::EventTraits<name> {            \
+        using Args = std::tuple<__VA_ARGS__>;              \
+        using Result = result;                             \
+        static constexpr const char* name_str = #name;     \
     };
 
+// ---- Priority (EventTraits<E>::priority, NORMAL if absent) ---- //
+enum class Priority : uint8_t {
+    HIGH = 0,     // control traffic: cancels, shutdown
+    NORMAL = 1,
+    BULK = 2
+};
+
+constexpr size_t kPriorityLanes = 3;
+
+template<typename EventTag, typename = void>
+struct event_priority {
+    static constexpr Priority value = Priority::NORMAL;
+};
+
+template<typename EventTag>
+struct event_priority<EventTag, std::void_t<decltype(EventTraits<EventTag>::priority)>> {
+    static constexpr Priority value = EventTraits<EventTag>::priority;
+};
+
+// ---- Event name (EventTraits<E>::name_str, if present) ---- //
+template<typename EventTag, typename = void>
+struct event_name {
+    static constexpr const char* value = "unnamed";
+};
+
+template<typename EventTag>
+struct event_name<EventTag, std::void_t<decltype(EventTraits<EventTag>::name_str)>> {
+    static constexpr const char* value = EventTraits<EventTag>::name_str;
+};
+
+// ---- Query events (EventTraits<E>::Result) ---- //
+template<typename EventTag, typename = void>
+struct is_query_event : std::false_type {};
+
+template<typename EventTag>
+struct is_query_event<EventTag, std::void_t<typename EventTraits<EventTag>::Result>> : std::true_type {};
+
+// What a query event carries through the loop: the arguments plus the slot
+// of the waiting Future (null for gen()). Dropping it unanswered breaks the
+// Future instead of leaving the caller blocked.
+template<typename Args, typename R>
+struct QueryPayload {
+    Args args;
+    detail::FutureSlot<R>* slot;
+
+    ~QueryPayload() {
+        if (slot) slot->abandon();
+    }
+};
+
+// ---- Stable event id (FNV-1a of the event name, 0 if unnamed) ---- //
+// Unlike TypeId, this survives process restarts, so it is what goes on disk
+// or over the wire.
+constexpr uint64_t fnv1a(const char* s, uint64_t h = 14695981039346656037ull) {
+    return *s ? fnv1a(s + 1, (h ^ static_cast<unsigned char>(*s)) * 1099511628211ull) : h;
+}
+
+template<typename EventTag, typename = void>
+struct event_id {
+    static constexpr uint64_t value = 0;
+};
+
+template<typename EventTag>
+struct event_id<EventTag, std::void_t<decltype(EventTraits<EventTag>::name_str)>> {
+    static constexpr uint64_t value = fnv1a(EventTraits<EventTag>::name_str);
+};
+
+// ---- Variable-size arguments ---- //
+// Argument types whose bytes travel inside the event payload itself:
+//
+//     OSKA_DEFINE_EVENT(EvLog, int, oska::InlineString)
+//     Corman.gen<EvLog>(3, oska::InlineString(line));     // any string_view
+//     Corman.connect<EvLog>(&loop, [](int level, oska::InlineString msg) { ... });
+//
+// Passed to gen() they only refer to the caller's bytes; gen() copies those
+// into the same allocation as the argument tuple, so an event costs one
+// allocation however many of them it carries. In the handler they stay
+// valid until it returns; keep a copy (str(), to_vector()) beyond that.
+class InlineString {
+public:
+    InlineString() = default;
+    explicit InlineString(std::string_view s) : data_(s.data()), size_(s.size()) {}
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    std::string_view view() const { return std::string_view(data_, size_); }
+    operator std::string_view() const { return view(); }
+    std::string str() const { return std::string(data_, size_); }
+
+private:
+    template<typename T> friend void adopt_inline_arg(T& arg, char*& out);
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+class InlineBytes {
+public:
+    InlineBytes() = default;
+    InlineBytes(const void* data, size_t size) : data_(static_cast<const uint8_t*>(data)), size_(size) {}
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const uint8_t* begin() const { return data_; }
+    const uint8_t* end() const { return data_ + size_; }
+    uint8_t operator[](size_t i) const { return data_[i]; }
+    std::vector<uint8_t> to_vector() const { return std::vector<uint8_t>(begin(), end()); }
+
+private:
+    template<typename T> friend void adopt_inline_arg(T& arg, char*& out);
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+template<typename T>
+struct is_inline_arg : std::bool_constant<std::is_same_v<T, InlineString> || std::is_same_v<T, InlineBytes>> {};
+
+template<typename Tuple>
+struct has_inline_args : std::false_type {};
+
+template<typename... Args>
+struct has_inline_args<std::tuple<Args...>> : std::bool_constant<(is_inline_arg<Args>::value || ...)> {};
+
+template<typename T>
+size_t inline_arg_size(const T& arg) {
+    if constexpr (is_inline_arg<std::decay_t<T>>::value) {
+        return arg.size();
+    } else {
+        return 0;
+    }
+}
+
+// Copies an inline argument's bytes to `out` and points it there.
+template<typename T>
+void adopt_inline_arg(T& arg, char*& out) {
+    if constexpr (is_inline_arg<T>::value) {
+        if (arg.size_) std::memcpy(out, arg.data_, arg.size_);
+        arg.data_ = reinterpret_cast<decltype(arg.data_)>(out);
+        out += arg.size_;
+    }
+}
+
+// The argument tuple of a payload: the tuple itself, or its `args` member.
+template<typename T>
+struct is_tuple : std::false_type {};
+
+template<typename... Ts>
+struct is_tuple<std::tuple<Ts...>> : std::true_type {};
+
+template<typename T>
+auto& payload_args(T& payload) {
+    if constexpr (is_tuple<T>::value) {
+        return payload;
+    } else {
+        return payload.args;
+    }
+}
+
+// Allocates an event payload (argument tuple, QueryPayload, ...) built
+// from `init`. With inline arguments, their `extra` bytes follow the
+// payload in the same block; free it with delete_payload() only.
+template<typename T, typename... Init>
+T* new_payload(size_t extra, Init&&... init) {
+    using Args = std::remove_reference_t<decltype(payload_args(std::declval<T&>()))>;
+    if constexpr (!has_inline_args<Args>::value) {
+        return new T{std::forward<Init>(init)...};
+    } else {
+        void* block = ::operator new(sizeof(T) + extra);
+        T* payload = new (block) T{std::forward<Init>(init)...};
+        char* out = reinterpret_cast<char*>(payload) + sizeof(T);
+        std::apply([&out](auto&... args) { (adopt_inline_arg(args, out), ...); }, payload_args(*payload));
+        return payload;
+    }
+}
+
+template<typename T>
+void delete_payload(T* payload) {
+    using Args = std::remove_reference_t<decltype(payload_args(std::declval<T&>()))>;
+    if constexpr (!has_inline_args<Args>::value) {
+        delete payload;
+    } else if (payload) {
+        payload->~T();
+        ::operator delete(payload);
+    }
+}
+
+// ---- Trivially copyable argument packing ---- //
+// Arguments are laid out back to back with memcpy; std::tuple itself is not
+// trivially copyable, so its elements are packed one by one. Arguments that
+// hold an address are never packable, since the bytes outlive the address
+// space they point into: inline arguments, pointers, member pointers,
+// references and views (string_view, span). Such events do not compile for
+// journal::Replayer or the remote loops; carry the bytes in an InlineString,
+// InlineBytes or a fixed-size array instead.
+template<typename T>
+struct holds_address : std::bool_constant<std::is_pointer_v<T> || std::is_member_pointer_v<T> ||
+                                          is_inline_arg<T>::value> {};
+
+template<typename T, size_t N>
+struct holds_address<T[N]> : holds_address<T> {};
+
+template<typename C, typename Traits>
+struct holds_address<std::basic_string_view<C, Traits>> : std::true_type {};
+
+template<typename T>
+struct holds_address<std::reference_wrapper<T>> : std::true_type {};
+
+#ifdef __cpp_lib_span
+template<typename T, size_t N>
+struct holds_address<std::span<T, N>> : std::true_type {};
+#endif
+
+template<typename Tuple>
+struct ArgsCodec {
+    static constexpr bool packable = false;
+};
+
+template<typename... Args>
+struct ArgsCodec<std::tuple<Args...>> {
+    static constexpr bool packable = ((std::is_trivially_copyable_v<Args> && !holds_address<Args>::value) && ...);
+    static constexpr size_t size = (size_t(0) + ... + sizeof(Args));
+
+    static void encode(const void* tuple, char* out) {
+        std::apply([&out](const Args&... args) {
+            ((std::memcpy(out, &args, sizeof(Args)), out += sizeof(Args)), ...);
+        }, *static_cast<const std::tuple<Args...>*>(tuple));
+    }
+
+    static std::tuple<Args...>* decode(const char* in) {
+        return new std::tuple<Args...>{read<Args>(in)...};
+    }
+
+private:
+    template<typename T>
+    static T read(const char*& in) {
+        alignas(T) unsigned char raw[sizeof(T)];
+        std::memcpy(raw, in, sizeof(T));
+        in += sizeof(T);
+        return *reinterpret_cast<T*>(raw);
+    }
+};
+
+// ---- EventRecorder ---- //
+// Sees every gen() of a named event whose arguments are packable.
+class EventRecorder {
+public:
+    using Encoder = void (*)(const void* tuple, char* out);
+    virtual void record(uint64_t id, size_t size, Encoder encode, const void* tuple) = 0;
+};
+
 // ---- Callback and Event Wrapper ---- //
 using Callback = std::function<void(void*)>;
+// A run of consecutive events of one tag; the handler owns every payload.
+using BatchCallback = std::function<void(void* const* data, size_t count)>;
 
 struct EventWrapper {
     size_t tag;
     void* data;
+    Priority priority = Priority::NORMAL;
+    uint64_t deadline_ns = 0;              // trace::now_ns() clock, 0 for none
+    void (*discard)(void*) = nullptr;      // frees `data` without handling it
+#ifdef OSKA_TRACING
+    uint64_t gen_ns = 0;   // stamped by CormanManager::gen
+    uint64_t post_ns = 0;  // stamped just before EventLoopInterface::post
+#endif
 
     EventWrapper() : tag(oska::TypeId<void>::value()), data(nullptr) {}
     EventWrapper(std::size_t t, void* d) : tag(t), data(d) {}
 };
 
+// For loops that drop an event instead of running its handler.
+inline void discard_event(const EventWrapper& ev) {
+    if (ev.discard) ev.discard(ev.data);
+}
+
+// Tag of the closures posted with EventLoopInterface::post_task().
+struct LoopTask {};
+
 class EventQueueInterface {
 public:
     virtual void push(const EventWrapper& ev) = 0;
@@ -53,8 +356,83 @@ public:
 class EventLoopInterface {
 public:
     virtual void post(size_t tag, void* data) = 0;
+    // Loops that queue EventWrapper directly should override this to keep
+    // the trace timestamps; the default drops them.
+    virtual void post(const EventWrapper& ev) { post(ev.tag, ev.data); }
+    // Several events from one producer in order. Loops should take their
+    // queue lock and wake the consumer once for the whole batch.
+    virtual void post_batch(const EventWrapper* evs, size_t count) {
+        for (size_t i = 0; i < count; ++i) post(evs[i]);
+    }
     virtual void connect(size_t tag, Callback cb) = 0;
     virtual void run() = 0;
+
+    // Forgets the handlers of `tag`; events with it that are still queued
+    // are discarded. Called on the loop's thread when it accepts tasks.
+    virtual void disconnect(size_t) {}
+
+    // Hands runs of consecutive queued events with this tag to `cb` in one
+    // call instead of one callback each. connect() for the same tag replaces
+    // it. Returns false if the loop does not group events.
+    virtual bool connect_batch(size_t, BatchCallback) { return false; }
+
+    // Called only from this loop's own thread (see LocalDispatch). Loops with
+    // an owner-only queue take the event without any synchronization and
+    // return true; the default declines and the event goes through post().
+    virtual bool post_local(const EventWrapper&) { return false; }
+
+    // Runs `cb` for `ev` at once on this loop's own thread (LocalDispatch::
+    // INLINE). Loops that trace their handlers override it to do the same
+    // here; nothing is queued ahead of the event, so `depth` is 0.
+    virtual void run_inline(const EventWrapper& ev, const Callback& cb) {
+        HandlerProbe probe(this, ev.tag, 0, ev.data);
+        cb(ev.data);
+    }
+
+    // The loop whose run() is executing on the calling thread, if any.
+    static EventLoopInterface* current() { return current_; }
+
+    // ---- Loop tasks ---- //
+    // A closure run on the loop's thread, in queue order with the events
+    // posted before it (in the same priority lane). Loops that support tasks
+    // override accepts_tasks() and hand every event to run_task() before
+    // looking up its handler.
+    virtual bool accepts_tasks() const { return false; }
+
+    bool post_task(std::function<void()> fn, Priority priority = Priority::NORMAL) {
+        if (!accepts_tasks()) return false;
+        EventWrapper ev(TypeId<LoopTask>::value(), new std::function<void()>(std::move(fn)));
+        ev.priority = priority;
+        ev.discard = [](void* data) { delete static_cast<std::function<void()>*>(data); };
+        post(ev);
+        return true;
+    }
+
+    // Events queued and not yet handled; 0 if the loop does not track it.
+    virtual size_t backlog() { return 0; }
+
+protected:
+    // True if `ev` was a task, which has now run.
+    static bool run_task(const EventWrapper& ev) {
+        if (ev.tag != TypeId<LoopTask>::value()) return false;
+        std::unique_ptr<std::function<void()>> fn(static_cast<std::function<void()>*>(ev.data));
+        (*fn)();
+        return true;
+    }
+
+    // Loops hold one of these for the duration of run().
+    class RunScope {
+    public:
+        explicit RunScope(EventLoopInterface* loop) : prev_(current_) { current_ = loop; }
+        ~RunScope() { current_ = prev_; }
+        RunScope(const RunScope&) = delete;
+        RunScope& operator=(const RunScope&) = delete;
+    private:
+        EventLoopInterface* prev_;
+    };
+
+private:
+    inline static thread_local EventLoopInterface* current_ = nullptr;
 };
 
 // ---- Type Traits for Event Arguments ---- //
@@ -66,63 +444,1001 @@ struct is_invocable_from_tuple<std::tuple<Args...>, F> {
     static constexpr bool value = std::is_invocable_v<F, Args...>;
 };
 
+// A filter over an event's arguments: bool(const Args&...).
+template<typename Tuple, typename F>
+struct is_filter_for;
+
+template<typename... Args, typename F>
+struct is_filter_for<std::tuple<Args...>, F> {
+    static constexpr bool value = std::is_invocable_r_v<bool, F&, const Args&...>;
+};
+
+// The arguments of a gen() call, by reference, before anything is copied.
+template<typename Tuple>
+struct arg_refs;
+
+template<typename... Args>
+struct arg_refs<std::tuple<Args...>> {
+    using type = std::tuple<const Args&...>;
+};
+
+template<typename Tuple, typename F>
+struct invoke_result_from_tuple;
+
+template<typename... Args, typename F>
+struct invoke_result_from_tuple<std::tuple<Args...>, F> {
+    using type = std::invoke_result_t<F, Args&...>;
+};
+
+
+// ---- Local dispatch ---- //
+// What gen() does when the target loop is the one running on the calling
+// thread. INLINE runs the handler immediately, up to a nesting depth, and
+// then falls back to LOCAL_QUEUE; both run the event ahead of anything the
+// loop already has queued from other threads.
+enum class LocalDispatch {
+    POST,           // always go through EventLoopInterface::post
+    LOCAL_QUEUE,    // EventLoopInterface::post_local, post() if declined
+    INLINE
+};
+
+// ---- EventBatch ---- //
+// What a connect_batch() handler receives: the arguments of `size()`
+// consecutive events of one type. Rows are the payload tuples in place;
+// column<I>() gathers argument I of every row into one contiguous vector
+// (structure of arrays) the first time it is asked for, so a handler can
+// run a vectorizable loop over it:
+//
+//     Corman.connect_batch<EvTick>(&loop, [](const EventBatch<EvTick>& ticks) {
+//         const auto& px = ticks.column<1>();
+//         double sum = std::accumulate(px.begin(), px.end(), 0.0);
+//         ...
+//     });
+template<typename EventTag>
+class EventBatch {
+public:
+    using Args = typename EventTraits<EventTag>::Args;
+
+    EventBatch(void* const* data, size_t count) : data_(data), count_(count) {}
+
+    EventBatch(const EventBatch&) = delete;
+    EventBatch& operator=(const EventBatch&) = delete;
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    const Args& operator[](size_t i) const { return *static_cast<const Args*>(data_[i]); }
+
+    template<size_t I>
+    const std::vector<std::tuple_element_t<I, Args>>& column() const {
+        auto& out = std::get<I>(columns_);
+        if (!(built_ & (1u << I))) {
+            out.reserve(count_);
+            for (size_t i = 0; i < count_; ++i) out.push_back(std::get<I>((*this)[i]));
+            built_ |= 1u << I;
+        }
+        return out;
+    }
+
+private:
+    template<typename Tuple>
+    struct Columns;
+
+    template<typename... Ts>
+    struct Columns<std::tuple<Ts...>> {
+        using type = std::tuple<std::vector<Ts>...>;
+    };
+
+    static_assert(std::tuple_size_v<Args> <= 32, "EventBatch supports up to 32 arguments");
+
+    void* const* data_;
+    size_t count_;
+    mutable typename Columns<Args>::type columns_;
+    mutable uint32_t built_ = 0;
+};
 
 // ---- CormanManager ---- //
 class CormanManager {
 public:
     template<typename EventTag, typename Func>
     void connect(EventLoopInterface* loop, Func handler) {
+        bind<EventTag>(loop, make_callback<EventTag>(std::move(handler)), nullptr, nullptr);
+    }
+
+    // ---- Filters ---- //
+    // connect() with a predicate over the event's arguments, checked in gen()
+    // before the payload is allocated; events it rejects are never queued.
+    // A later connect() without a filter removes it.
+    template<typename EventTag, typename Func, typename Filter>
+    void connect(EventLoopInterface* loop, Func handler, Filter filter) {
+        using ExpectedArgs = typename EventTraits<EventTag>::Args;
+        static_assert(!is_query_event<EventTag>::value, "Query events cannot be filtered");
+        static_assert(is_filter_for<ExpectedArgs, Filter>::value,
+                      "Filter must be callable as bool(const Args&...)");
+
+        typename TagFilter<EventTag>::Accept accept = [filter](const typename TagFilter<EventTag>::Refs& refs) mutable {
+            return std::apply(filter, refs);
+        };
+        bind<EventTag>(loop, make_callback<EventTag>(std::move(handler)), nullptr, std::move(accept));
+    }
+
+    // Indexed routing: events whose argument I equals `key` go to `loop` and
+    // `handler`, found with one hash lookup in gen(). Events matching no key
+    // go to the plain connect() binding, if any, or are dropped. One
+    // argument per event type is indexed; keys on another argument replace
+    // the index. These routes are not migrated or load tracked.
+    //
+    // A route's handler is registered with its loop under a tag of its own.
+    // Replacing or disconnecting the route unregisters it behind the events
+    // already queued, which still reach the old handler.
+    template<typename EventTag, size_t I, typename Key, typename Func>
+    void connect_where(const Key& key, EventLoopInterface* loop, Func handler) {
+        static_assert(!is_query_event<EventTag>::value, "Query events cannot be filtered");
+        using K = std::tuple_element_t<I, typename EventTraits<EventTag>::Args>;
+
+        auto route = std::make_shared<Subscription>();
+        route->target = loop;
+        route->callback = make_callback<EventTag>(std::move(handler));
+        route->tag = next_route_tag();
+        trace::Registry::instance().name_event(route->tag, event_name<EventTag>::value);
+        if (loop) loop->connect(route->tag, route->callback);
+
+        Routes dropped;
+        update_filter<EventTag>([&](TagFilter<EventTag>& filter) {
+            std::shared_ptr<Index<K>> index;
+            if (filter.index_arg == I && filter.index) {
+                index = std::make_shared<Index<K>>(*std::static_pointer_cast<const Index<K>>(filter.index));
+                auto it = index->find(K(key));
+                if (it != index->end()) dropped.push_back(std::move(it->second));
+            } else {
+                if (filter.routes) filter.routes(dropped);
+                index = std::make_shared<Index<K>>();
+            }
+            (*index)[K(key)] = route;
+            set_index<EventTag, I, K>(filter, std::move(index));
+        });
+        for (auto& old : dropped) unregister(*old);
+    }
+
+    template<typename EventTag, size_t I, typename Key>
+    void disconnect_where(const Key& key) {
+        using K = std::tuple_element_t<I, typename EventTraits<EventTag>::Args>;
+        Routes dropped;
+        update_filter<EventTag>([&](TagFilter<EventTag>& filter) {
+            if (filter.index_arg != I || !filter.index) return;
+            auto index = std::make_shared<Index<K>>(*std::static_pointer_cast<const Index<K>>(filter.index));
+            auto it = index->find(K(key));
+            if (it == index->end()) return;
+            dropped.push_back(std::move(it->second));
+            index->erase(it);
+            if (index->empty()) {
+                filter.index = nullptr;
+                filter.find = nullptr;
+                filter.routes = nullptr;
+                filter.index_arg = kNoIndex;
+            } else {
+                set_index<EventTag, I, K>(filter, std::move(index));
+            }
+        });
+        for (auto& old : dropped) unregister(*old);
+    }
+
+    // Events dropped by a filter since construction.
+    uint64_t filtered_out() const { return filtered_out_.load(std::memory_order_relaxed); }
+
+private:
+    template<typename EventTag, typename Func>
+    static Callback make_callback(Func handler) {
         using ExpectedArgs = typename EventTraits<EventTag>::Args;
 
         static_assert(is_invocable_from_tuple<ExpectedArgs, Func>::value,
                     "Handler is not callable with arguments from EventTraits");
 
-        Callback cb = [handler](void* data) {
-            auto tuple = static_cast<ExpectedArgs*>(data);
-            std::apply(handler, *tuple);
-            delete tuple;
-        };
+        Callback cb;
+        if constexpr (is_query_event<EventTag>::value) {
+            using R = typename EventTraits<EventTag>::Result;
+            using Payload = QueryPayload<ExpectedArgs, R>;
+            static_assert(std::is_convertible_v<typename invoke_result_from_tuple<ExpectedArgs, Func>::type, R>,
+                          "Query handler must return EventTraits::Result");
 
-        auto tag = oska::TypeId<EventTag>::value();
+            cb = [handler](void* data) {
+                auto payload = static_cast<Payload*>(data);
+                if (payload->slot) {
+                    payload->slot->complete(std::apply(handler, payload->args));
+                    payload->slot->release();
+                    payload->slot = nullptr;
+                } else {
+                    std::apply(handler, payload->args);
+                }
+                delete_payload(payload);
+            };
+        } else {
+            cb = [handler](void* data) {
+                auto tuple = static_cast<ExpectedArgs*>(data);
+                std::apply(handler, *tuple);
+                delete_payload(tuple);
+            };
+        }
+        return cb;
+    }
 
-        std::unique_lock<std::mutex> lock(mtx);
-        bindings[tag] = {loop, cb};
-        if (loop) loop->connect(tag, cb);
+public:
+    // Like connect(), but `handler` takes a const EventBatch<EventTag>& and
+    // gets every run of consecutive events of this type the loop has queued
+    // at once. Loops that do not group events (and gen() handled inline)
+    // call it with batches of one.
+    template<typename EventTag, typename Func>
+    void connect_batch(EventLoopInterface* loop, Func handler) {
+        using ExpectedArgs = typename EventTraits<EventTag>::Args;
+        static_assert(!is_query_event<EventTag>::value, "Query events need a reply per event; use connect()");
+        static_assert(std::is_invocable_v<Func&, const EventBatch<EventTag>&>,
+                      "Batch handler must take const EventBatch<EventTag>&");
+
+        BatchCallback batch = [handler](void* const* data, size_t count) mutable {
+            {
+                EventBatch<EventTag> events(data, count);
+                handler(static_cast<const EventBatch<EventTag>&>(events));
+            }
+            for (size_t i = 0; i < count; ++i) delete_payload(static_cast<ExpectedArgs*>(data[i]));
+        };
+        Callback cb = [batch](void* data) { batch(&data, 1); };
+        bind<EventTag>(loop, std::move(cb), std::move(batch), nullptr);
     }
 
     template<typename EventTag, typename... PassedArgs>
     void gen(PassedArgs&&... args) {
-        
+        generate<EventTag>(0, std::forward<PassedArgs>(args)...);
+    }
+
+    // gen() for an event that is useless after `deadline`. Loops that
+    // schedule by deadline (PriorityEventLoop with Deadlines::EDF) run it
+    // ahead of later deadlines and drop or divert it once it has expired;
+    // other loops treat it like any other event.
+    template<typename EventTag, typename... PassedArgs>
+    void gen_with_deadline(std::chrono::steady_clock::time_point deadline, PassedArgs&&... args) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+        generate<EventTag>(ns > 0 ? static_cast<uint64_t>(ns) : 1, std::forward<PassedArgs>(args)...);
+    }
+
+    // Request/response: the returned Future completes with the handler's
+    // return value, or empty if no handler is bound. When called from the
+    // target loop's own thread the handler runs inline, so waiting on the
+    // Future there cannot deadlock.
+    template<typename EventTag, typename... PassedArgs>
+    Future<typename EventTraits<EventTag>::Result> call(PassedArgs&&... args) {
+        static_assert(is_query_event<EventTag>::value, "call() needs an OSKA_DEFINE_QUERY_EVENT event");
 
         using ExpectedArgs = typename EventTraits<EventTag>::Args;
         using ProvidedArgs = std::tuple<std::decay_t<PassedArgs>...>;
+        using R = typename EventTraits<EventTag>::Result;
 
         static_assert(std::is_same<ProvidedArgs, ExpectedArgs>::value,
                       "Argument types do not match EventTraits");
 
-        auto* tuple = new ExpectedArgs{std::forward<PassedArgs>(args)...};
+        auto* slot = detail::FutureSlot<R>::acquire();
+        Future<R> future(slot);
+
+        size_t extra = (size_t(0) + ... + inline_arg_size(args));
+        auto* payload = new_payload<QueryPayload<ExpectedArgs, R>>(extra, ExpectedArgs{std::forward<PassedArgs>(args)...}, slot);
+        record<EventTag>(&payload->args);
+
+        EventWrapper ev = make_wrapper<EventTag>(payload);
+        OSKA_PROBE3(gen, ev.tag, ev.data, ev.deadline_ns);
+        flush();  // keep order with anything this thread has batched
+        Route route = lookup(ev, true);
+        if (route.held) return future;
+
+        if (route.target && route.target == EventLoopInterface::current()) {
+            OSKA_PROBE3(dispatch, ev.tag, ev.data, route.target);
+            posted(route);
+            (*route.callback)(payload);
+        } else {
+            bool sent = post_to(route.target, ev);
+            posted(route);
+            if (sent) {
+                OSKA_PROBE3(dispatch, ev.tag, ev.data, route.target);
+            } else {
+                OSKA_PROBE2(undelivered, ev.tag, ev.data);
+                delete_payload(payload);
+            }
+        }
+        return future;
+    }
+
+    // ---- Live rebinding ---- //
+    // Moves `tag` to the loop `to` while it keeps running, without
+    // reordering it: new events for the tag are held back, a task posted to
+    // the old loop marks the end of what it already has queued, and once
+    // that has run the new loop takes over -- first the held events, then
+    // new ones. The future completes with false if nothing was moved (tag not
+    // bound, same loop, a migration already running, or a loop that does not
+    // accept tasks) or if connect() rebound the tag before the move finished;
+    // the events held meanwhile then go to the new binding.
+    //
+    // Per-tag order is kept for plain gen(). Events a thread still holds
+    // with producer batching when the move starts reach the old loop late
+    // and are forwarded, after what the new loop already has. Do not call
+    // from the old loop's own thread, and keep both loops running until the
+    // future is ready.
+    Future<bool> migrate(size_t tag, EventLoopInterface* to) {
+        auto* slot = detail::FutureSlot<bool>::acquire();
+        Future<bool> future(slot);
+
+        EventLoopInterface* from = nullptr;
+        TagState* state = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            auto it = bindings.find(tag);
+            uint64_t generation = 0;
+            if (it != bindings.end()) {
+                from = it->second.target;
+                state = it->second.state.get();
+                generation = it->second.generation;
+            }
+            if (!state || !from || !to || from == to || state->migrating ||
+                !from->accepts_tasks() || !to->accepts_tasks()) {
+                lock.unlock();
+                slot->complete(false);
+                slot->release();
+                return future;
+            }
+            state->migrating = true;
+            state->migrated_generation = generation;
+            epoch.store(next_epoch(), std::memory_order_release);
+        }
+
+        // gen() calls that already resolved to `from` post before the fence.
+        while (state->posting.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+
+        Priority priority = state->priority;
+        from->post_task([this, state, to, slot, priority] {
+            to->post_task([this, state, to, slot] {
+                slot->complete(cut_over(state, to));
+                slot->release();
+            }, priority);
+        }, priority);
+        return future;
+    }
+
+    template<typename EventTag>
+    Future<bool> migrate(EventLoopInterface* to) {
+        return migrate(oska::TypeId<EventTag>::value(), to);
+    }
+
+    // ---- Load accounting ---- //
+    struct TagLoad {
+        size_t tag;
+        EventLoopInterface* target;
+        uint64_t handled;
+        uint64_t busy_ns;     // handler time, only while load tracking is on
+    };
 
+    // Times every handler run by a loop (two clock reads per event).
+    void set_load_tracking(bool on) {
+        track_load_.store(on, std::memory_order_relaxed);
+    }
+
+    std::vector<TagLoad> loads() {
         std::unique_lock<std::mutex> lock(mtx);
-        dispatch(oska::TypeId<EventTag>::value(), static_cast<void*>(tuple));
+        std::vector<TagLoad> out;
+        for (const auto& entry : bindings) {
+            const TagState& state = *entry.second.state;
+            out.push_back(TagLoad{entry.first, entry.second.target,
+                                  state.handled.load(std::memory_order_relaxed),
+                                  state.busy_ns.load(std::memory_order_relaxed)});
+        }
+        return out;
+    }
+
+    // ---- Producer batching (per thread, opt-in) ---- //
+    // While enabled on a thread, gen() from that thread buffers events per
+    // target loop and hands each loop up to `threshold` of them at once via
+    // post_batch(). Routes are cached per thread and invalidated by connect().
+    // Buffered events go out when a loop's buffer fills, on flush(), when
+    // batching is disabled, or when the thread exits. Loops call flush() after
+    // every handler, so events generated by a handler leave when it returns.
+    static void enable_batching(size_t threshold = 64) {
+        batch_.threshold = threshold ? threshold : 1;
+    }
+
+    static void disable_batching() {
+        batch_.flush();
+        batch_.threshold = 0;
+    }
+
+    static bool batching() { return batch_.threshold != 0; }
+
+    static void flush() {
+        if (batch_.pending) batch_.flush();
+    }
+
+    // Enables batching for a scope, then flushes and restores the previous
+    // setting.
+    class BatchScope {
+    public:
+        explicit BatchScope(size_t threshold = 64) : prev_(batch_.threshold) { enable_batching(threshold); }
+        ~BatchScope() {
+            batch_.flush();
+            batch_.threshold = prev_;
+        }
+        BatchScope(const BatchScope&) = delete;
+        BatchScope& operator=(const BatchScope&) = delete;
+    private:
+        size_t prev_;
+    };
+
+    void set_local_dispatch(LocalDispatch mode, unsigned max_inline_depth = 8) {
+        local_mode.store(mode, std::memory_order_relaxed);
+        max_inline_depth_.store(max_inline_depth, std::memory_order_relaxed);
+    }
+
+    // Pass nullptr to stop recording. The recorder must outlive any gen()
+    // that may still be running when it is detached.
+    void set_recorder(EventRecorder* rec) {
+        recorder.store(rec, std::memory_order_release);
     }
 
 private:
-    void dispatch(size_t tag, void* data) {
-        auto it = bindings.find(tag);
-        if (it != bindings.end() && it->second.target) {
-            it->second.target->post(tag, data);
+    template<typename EventTag, typename... PassedArgs>
+    void generate(uint64_t deadline_ns, PassedArgs&&... args) {
+        using ExpectedArgs = typename EventTraits<EventTag>::Args;
+        using ProvidedArgs = std::tuple<std::decay_t<PassedArgs>...>;
+
+        static_assert(std::is_same<ProvidedArgs, ExpectedArgs>::value,
+                      "Argument types do not match EventTraits");
+
+        size_t inline_bytes = (size_t(0) + ... + inline_arg_size(args));
+        if constexpr (!is_query_event<EventTag>::value) {
+            if (filtered_tags_.load(std::memory_order_acquire) != 0) {
+                if (auto filter = filter_for<EventTag>()) {
+                    typename TagFilter<EventTag>::Refs refs(args...);
+                    if (const Subscription* route = filter->find ? filter->find(refs) : nullptr) {
+                        auto* tuple = new_payload<ExpectedArgs>(inline_bytes, std::forward<PassedArgs>(args)...);
+                        record<EventTag>(tuple);
+                        EventWrapper ev = make_wrapper<EventTag>(tuple);
+                        ev.tag = route->tag;
+                        ev.deadline_ns = deadline_ns;
+                        OSKA_PROBE3(gen, ev.tag, ev.data, ev.deadline_ns);
+                        if (!route->target) {
+                            OSKA_PROBE2(undelivered, ev.tag, ev.data);
+                            discard_event(ev);
+                            return;
+                        }
+                        OSKA_PROBE3(dispatch, ev.tag, ev.data, route->target);
+                        Route r;
+                        r.target = route->target;
+                        r.callback = std::shared_ptr<const Callback>(filter, &route->callback);
+                        LocalDispatch mode = local_mode.load(std::memory_order_relaxed);
+                        deliver(r, ev, mode, batch_.threshold != 0);
+                        return;
+                    }
+                    if (filter->accept && !filter->accept(refs)) {
+                        OSKA_PROBE1(filtered, oska::TypeId<EventTag>::value());
+                        filtered_out_.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+            }
+        }
+
+        void* data;
+        if constexpr (is_query_event<EventTag>::value) {
+            using R = typename EventTraits<EventTag>::Result;
+            auto* payload = new_payload<QueryPayload<ExpectedArgs, R>>(inline_bytes, ExpectedArgs{std::forward<PassedArgs>(args)...}, nullptr);
+            record<EventTag>(&payload->args);
+            data = payload;
+        } else {
+            auto* tuple = new_payload<ExpectedArgs>(inline_bytes, std::forward<PassedArgs>(args)...);
+            record<EventTag>(tuple);
+            data = tuple;
+        }
+
+        EventWrapper ev = make_wrapper<EventTag>(data);
+        ev.deadline_ns = deadline_ns;
+        OSKA_PROBE3(gen, ev.tag, ev.data, ev.deadline_ns);
+        if (!dispatch(ev)) {
+            OSKA_PROBE2(undelivered, ev.tag, ev.data);
+            discard_event(ev);
         }
     }
 
-    struct Binding {
-        EventLoopInterface* target;
+    template<typename EventTag>
+    static void discard_payload(void* data) {
+        using ExpectedArgs = typename EventTraits<EventTag>::Args;
+        if constexpr (is_query_event<EventTag>::value) {
+            delete_payload(static_cast<QueryPayload<ExpectedArgs, typename EventTraits<EventTag>::Result>*>(data));
+        } else {
+            delete_payload(static_cast<ExpectedArgs*>(data));
+        }
+    }
+
+    template<typename EventTag>
+    void record(const typename EventTraits<EventTag>::Args* tuple) {
+        using ExpectedArgs = typename EventTraits<EventTag>::Args;
+        if constexpr (ArgsCodec<ExpectedArgs>::packable && event_id<EventTag>::value != 0) {
+            if (auto* rec = recorder.load(std::memory_order_acquire)) {
+                rec->record(event_id<EventTag>::value, ArgsCodec<ExpectedArgs>::size,
+                            &ArgsCodec<ExpectedArgs>::encode, tuple);
+            }
+        }
+    }
+
+    template<typename EventTag>
+    static EventWrapper make_wrapper(void* data) {
+        EventWrapper ev(oska::TypeId<EventTag>::value(), data);
+        ev.priority = event_priority<EventTag>::value;
+        ev.discard = &discard_payload<EventTag>;
+#ifdef OSKA_TRACING
+        ev.gen_ns = trace::now_ns();
+#endif
+        return ev;
+    }
+
+    // An indexed route: its own tag, so the loop finds its handler directly.
+    struct Subscription {
+        size_t tag = 0;
+        EventLoopInterface* target = nullptr;
         Callback callback;
     };
 
+    template<typename K>
+    using Index = std::unordered_map<K, std::shared_ptr<Subscription>>;
+    using Routes = std::vector<std::shared_ptr<Subscription>>;
+
+    // Route tags count up from 1, far below any TypeId (the address of a
+    // static), and are never reused: an event still queued for a dropped
+    // route can't reach a newer one.
+    static size_t next_route_tag() {
+        static std::atomic<size_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // Drops a replaced route's handler from its loop. Loops that run tasks
+    // do it on their own thread, after the events already queued for it.
+    static void unregister(const Subscription& route) {
+        EventLoopInterface* loop = route.target;
+        if (!loop) return;
+        size_t tag = route.tag;
+        if (!loop->post_task([loop, tag] { loop->disconnect(tag); })) loop->disconnect(tag);
+    }
+
+    static constexpr size_t kNoIndex = static_cast<size_t>(-1);
+
+    struct FilterBase {
+        virtual ~FilterBase() = default;
+    };
+
+    // Filters of one event type. Published copies are never modified;
+    // changes build a new one under mtx.
+    template<typename EventTag>
+    struct TagFilter : FilterBase {
+        using Refs = typename arg_refs<typename EventTraits<EventTag>::Args>::type;
+        using Accept = std::function<bool(const Refs&)>;
+
+        Accept accept;                                      // plain binding only
+        size_t index_arg = kNoIndex;
+        std::shared_ptr<const void> index;                  // Index<K> for argument index_arg
+        std::function<const Subscription*(const Refs&)> find;
+        std::function<void(Routes&)> routes;                // appends every indexed route
+
+        bool empty() const { return !accept && !find; }
+    };
+
+    // Thread-local filter cache per tag, like cached_lookup(): gen() takes
+    // `mtx` only after a connect() or filter change, and an event type
+    // without a filter costs no shared count either.
+    struct CachedFilter {
+        const CormanManager* manager = nullptr;
+        size_t tag = 0;
+        uint64_t epoch = 0;
+        std::shared_ptr<const FilterBase> filter;
+    };
+
+    static constexpr size_t kFilterSlots = 64;
+
+    template<typename EventTag>
+    std::shared_ptr<const TagFilter<EventTag>> filter_for() {
+        size_t tag = oska::TypeId<EventTag>::value();
+        uint64_t now = epoch.load(std::memory_order_acquire);
+        CachedFilter& cached = filter_cache_[tag % kFilterSlots];    // TypeId values are adjacent bytes
+        if (cached.manager != this || cached.tag != tag || cached.epoch != now) {
+            std::unique_lock<std::mutex> lock(mtx);
+            auto it = filters_.find(tag);
+            cached.filter = it == filters_.end() ? nullptr : it->second;
+            cached.manager = this;
+            cached.tag = tag;
+            cached.epoch = now;
+        }
+        if (!cached.filter) return nullptr;
+        return std::static_pointer_cast<const TagFilter<EventTag>>(cached.filter);
+    }
+
+    template<typename EventTag, typename Change>
+    void update_filter(Change change) {
+        std::unique_lock<std::mutex> lock(mtx);
+        modify_filter<EventTag>(change);
+    }
+
+    // Copies the tag's filter, applies `change` and publishes the result;
+    // called with mtx held.
+    template<typename EventTag, typename Change>
+    void modify_filter(Change&& change) {
+        size_t tag = oska::TypeId<EventTag>::value();
+        auto it = filters_.find(tag);
+        auto next = it == filters_.end()
+            ? std::make_shared<TagFilter<EventTag>>()
+            : std::make_shared<TagFilter<EventTag>>(static_cast<const TagFilter<EventTag>&>(*it->second));
+        change(*next);
+
+        if (next->empty()) {
+            if (it != filters_.end()) {
+                filters_.erase(it);
+                filtered_tags_.fetch_sub(1, std::memory_order_release);
+            }
+        } else if (it != filters_.end()) {
+            it->second = std::move(next);
+        } else {
+            filters_.emplace(tag, std::move(next));
+            filtered_tags_.fetch_add(1, std::memory_order_release);
+        }
+        epoch.store(next_epoch(), std::memory_order_release);
+    }
+
+    template<typename EventTag, size_t I, typename K>
+    static void set_index(TagFilter<EventTag>& filter, std::shared_ptr<Index<K>> index) {
+        filter.index_arg = I;
+        filter.find = [index](const typename TagFilter<EventTag>::Refs& refs) -> const Subscription* {
+            auto it = index->find(std::get<I>(refs));
+            return it == index->end() ? nullptr : it->second.get();
+        };
+        filter.routes = [index](Routes& out) {
+            for (auto& entry : *index) out.push_back(entry.second);
+        };
+        filter.index = std::move(index);
+    }
+
+    // Per-tag state shared by the binding and the loop callbacks; lives as
+    // long as the manager, across reconnects.
+    struct TagState {
+        size_t tag = 0;
+        Priority priority = Priority::NORMAL;
+        void (*discard)(void*) = nullptr;
+        std::atomic<EventLoopInterface*> moved_to{nullptr}; // set by migrate()
+        std::atomic<uint32_t> posting{0};                  // gen()s between lookup and post
+        std::atomic<uint64_t> handled{0};
+        std::atomic<uint64_t> busy_ns{0};
+        bool migrating = false;                            // under mtx
+        uint64_t migrated_generation = 0;                  // under mtx, Binding::generation when it started
+        std::vector<EventWrapper> held;                    // under mtx, while migrating
+    };
+
+    // Owns its callback: a reconnect may replace the binding's while gen()
+    // still runs it inline.
+    struct Route {
+        EventLoopInterface* target = nullptr;
+        std::shared_ptr<const Callback> callback;
+        TagState* counted = nullptr;    // posting count to drop once posted
+        bool held = false;              // parked for a migration
+    };
+
+    struct Binding {
+        EventLoopInterface* target = nullptr;
+        std::shared_ptr<const Callback> callback;   // replaced, never modified, on reconnect
+        std::shared_ptr<const Callback> handler;    // loop_callback() of `callback`, as the loop runs it
+        BatchCallback batch;            // set by connect_batch()
+        std::shared_ptr<TagState> state;
+        uint64_t generation = 0;        // bumped by every bind()
+    };
+
+    template<typename EventTag>
+    void bind(EventLoopInterface* loop, Callback cb, BatchCallback batch, typename TagFilter<EventTag>::Accept accept) {
+        auto tag = oska::TypeId<EventTag>::value();
+        trace::Registry::instance().name_event(tag, event_name<EventTag>::value);
+
+        std::unique_lock<std::mutex> lock(mtx);
+        if (accept || filters_.count(tag)) {
+            modify_filter<EventTag>([&](TagFilter<EventTag>& filter) { filter.accept = std::move(accept); });
+        }
+        Binding& binding = bindings[tag];
+        if (!binding.state) {
+            binding.state = std::make_shared<TagState>();
+            binding.state->tag = tag;
+            binding.state->priority = event_priority<EventTag>::value;
+            binding.state->discard = &discard_payload<EventTag>;
+        }
+        binding.target = loop;
+        binding.callback = std::make_shared<const Callback>(std::move(cb));
+        binding.handler = nullptr;
+        binding.batch = std::move(batch);
+        binding.generation++;
+        binding.state->moved_to.store(nullptr, std::memory_order_release);
+        epoch.store(next_epoch(), std::memory_order_release);
+        if (loop) connect_loop(binding, loop);
+    }
+
+    // Registers the binding's handlers with `loop`; called with mtx held.
+    // Inline dispatch runs the same `handler`, so it is load tracked too.
+    void connect_loop(Binding& binding, EventLoopInterface* loop) {
+        binding.handler = std::make_shared<const Callback>(loop_callback(binding.state, loop, *binding.callback));
+        loop->connect(binding.state->tag, *binding.handler);
+        if (binding.batch) loop->connect_batch(binding.state->tag, loop_batch_callback(binding.state, loop, binding.batch));
+    }
+
+    // What a loop runs for a tag. Events that reach a loop the tag was
+    // migrated away from are forwarded; a plain reconnect does not forward.
+    Callback loop_callback(const std::shared_ptr<TagState>& state, EventLoopInterface* loop, const Callback& cb) {
+        return [this, state, loop, cb](void* data) {
+            EventLoopInterface* owner = state->moved_to.load(std::memory_order_acquire);
+            if (owner && owner != loop) {
+                EventWrapper ev(state->tag, data);
+                ev.priority = state->priority;
+                ev.discard = state->discard;
+                owner->post(ev);
+                return;
+            }
+            if (track_load_.load(std::memory_order_relaxed)) {
+                uint64_t start = trace::now_ns();
+                cb(data);
+                state->busy_ns.fetch_add(trace::now_ns() - start, std::memory_order_relaxed);
+            } else {
+                cb(data);
+            }
+            state->handled.fetch_add(1, std::memory_order_relaxed);
+        };
+    }
+
+    BatchCallback loop_batch_callback(const std::shared_ptr<TagState>& state, EventLoopInterface* loop, const BatchCallback& batch) {
+        return [this, state, loop, batch](void* const* data, size_t count) {
+            EventLoopInterface* owner = state->moved_to.load(std::memory_order_acquire);
+            if (owner && owner != loop) {
+                for (size_t i = 0; i < count; ++i) {
+                    EventWrapper ev(state->tag, data[i]);
+                    ev.priority = state->priority;
+                    ev.discard = state->discard;
+                    owner->post(ev);
+                }
+                return;
+            }
+            if (track_load_.load(std::memory_order_relaxed)) {
+                uint64_t start = trace::now_ns();
+                batch(data, count);
+                state->busy_ns.fetch_add(trace::now_ns() - start, std::memory_order_relaxed);
+            } else {
+                batch(data, count);
+            }
+            state->handled.fetch_add(count, std::memory_order_relaxed);
+        };
+    }
+
+    // Runs on the new loop's thread once the old loop has passed the fence.
+    // Returns false if a connect() rebound the tag during the move; the
+    // held events then go to wherever that left it.
+    bool cut_over(TagState* state, EventLoopInterface* to) {
+        Callback run;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            Binding& binding = bindings[state->tag];
+            if (binding.generation == state->migrated_generation) {
+                connect_loop(binding, to);
+                run = *binding.handler;
+                state->moved_to.store(to, std::memory_order_release);
+            }
+        }
+
+        std::vector<EventWrapper> held;
+        for (;;) {
+            EventLoopInterface* target = to;
+            bool rebound;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                held.swap(state->held);
+                Binding& binding = bindings[state->tag];
+                rebound = binding.generation != state->migrated_generation;
+                if (held.empty()) {
+                    if (!rebound) binding.target = to;
+                    state->migrating = false;
+                    epoch.store(next_epoch(), std::memory_order_release);
+                    return !rebound;
+                }
+                if (rebound) target = binding.target;
+            }
+            if (!rebound) {
+                for (auto& ev : held) run(ev.data);
+            } else if (target) {
+                target->post_batch(held.data(), held.size());
+            } else {
+                for (auto& ev : held) discard_event(ev);
+            }
+            held.clear();
+        }
+    }
+
+    // Only the lookup runs under `mtx`; a loop whose post() blocks on a full
+    // queue must not stall gen() for every other event. While the tag is
+    // being migrated the event is parked instead (Route::held). With
+    // `count_posting`, the caller reports the post with posted().
+    Route lookup(const EventWrapper& ev, bool count_posting) {
+        Route route;
+        std::unique_lock<std::mutex> lock(mtx);
+        auto it = bindings.find(ev.tag);
+        if (it == bindings.end()) return route;
+        TagState* state = it->second.state.get();
+        if (state->migrating) {
+            state->held.push_back(ev);
+            route.held = true;
+            return route;
+        }
+        route.target = it->second.target;
+        route.callback = it->second.handler;
+        if (count_posting && route.target) {
+            state->posting.fetch_add(1, std::memory_order_relaxed);
+            route.counted = state;
+        }
+        return route;
+    }
+
+    static void posted(const Route& route) {
+        if (route.counted) route.counted->posting.fetch_sub(1, std::memory_order_release);
+    }
+
+    bool post_to(EventLoopInterface* target, EventWrapper& ev) {
+        if (!target) return false;
+#ifdef OSKA_TRACING
+        ev.post_ns = trace::now_ns();
+#endif
+        target->post(ev);
+        return true;
+    }
+
+    // Epochs are unique across managers, so a thread's cached route never
+    // matches a manager rebuilt at the address of a destroyed one.
+    static uint64_t next_epoch() {
+        static std::atomic<uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // Thread-local route cache used while batching; skips `mtx` entirely.
+    Route cached_lookup(const EventWrapper& ev) {
+        uint64_t now = epoch.load(std::memory_order_acquire);
+        auto& cached = batch_.routes[(ev.tag >> 4) % ProducerBatch::kRoutes];
+        if (cached.manager != this || cached.tag != ev.tag || cached.epoch != now) {
+            Route route = lookup(ev, false);
+            if (route.held) return route;
+            cached.target = route.target;
+            cached.callback = route.callback;
+            cached.manager = this;
+            cached.tag = ev.tag;
+            cached.epoch = now;
+        }
+        Route route;
+        route.target = cached.target;
+        // Only an inline call needs the callback; spare the shared count otherwise.
+        if (route.target == EventLoopInterface::current()) route.callback = cached.callback;
+        return route;
+    }
+
+    // Returns false if nothing is bound; the caller still owns ev.data.
+    bool dispatch(EventWrapper ev) {
+        LocalDispatch mode = local_mode.load(std::memory_order_relaxed);
+        bool batching = batch_.threshold != 0;
+
+        Route route = batching ? cached_lookup(ev) : lookup(ev, true);
+        if (route.held) return true;
+        if (!route.target) return false;
+        OSKA_PROBE3(dispatch, ev.tag, ev.data, route.target);
+
+        bool done = deliver(route, ev, mode, batching);
+        posted(route);
+        return done;
+    }
+
+    bool deliver(const Route& route, EventWrapper& ev, LocalDispatch mode, bool batching) {
+        if (mode != LocalDispatch::POST && route.target == EventLoopInterface::current()) {
+            if (mode == LocalDispatch::INLINE && inline_depth_ < max_inline_depth_.load(std::memory_order_relaxed)) {
+                // route.callback was taken under mtx (or from this thread's
+                // cache) and keeps the handler alive across a reconnect.
+                InlineDepth depth;
+#ifdef OSKA_TRACING
+                ev.post_ns = trace::now_ns();
+#endif
+                route.target->run_inline(ev, *route.callback);
+                return true;
+            }
+            if (route.target->post_local(ev)) return true;
+        }
+
+        if (batching) {
+#ifdef OSKA_TRACING
+            ev.post_ns = trace::now_ns();
+#endif
+            batch_.add(route.target, ev);
+            return true;
+        }
+        return post_to(route.target, ev);
+    }
+
+    struct ProducerBatch {
+        struct Lane {
+            EventLoopInterface* target;
+            std::vector<EventWrapper> events;
+            std::vector<EventWrapper> spare;    // keeps its capacity between sends
+        };
+
+        struct Route {
+            const CormanManager* manager = nullptr;
+            size_t tag = 0;
+            uint64_t epoch = 0;
+            EventLoopInterface* target = nullptr;
+            std::shared_ptr<const Callback> callback;
+        };
+
+        static constexpr size_t kRoutes = 64;
+
+        std::vector<Lane> lanes;
+        Route routes[kRoutes];
+        size_t threshold = 0;   // 0: batching off
+        size_t pending = 0;
+
+        ~ProducerBatch() { flush(); }
+
+        void add(EventLoopInterface* target, const EventWrapper& ev) {
+            size_t i = 0;
+            while (i < lanes.size() && lanes[i].target != target) ++i;
+            if (i == lanes.size()) {
+                lanes.push_back(Lane{target, {}, {}});
+                lanes[i].events.reserve(threshold);
+            }
+
+            lanes[i].events.push_back(ev);
+            pending++;
+            if (lanes[i].events.size() >= threshold) send(i);
+        }
+
+        // Works by index and empties the lane before posting, since
+        // post_batch may run handlers that gen() on this thread again.
+        void send(size_t i) {
+            std::vector<EventWrapper> out;
+            out.swap(lanes[i].events);
+            lanes[i].events.swap(lanes[i].spare);
+            pending -= out.size();
+
+            lanes[i].target->post_batch(out.data(), out.size());
+
+            out.clear();
+            lanes[i].spare.swap(out);
+        }
+
+        void flush() {
+            for (size_t i = 0; i < lanes.size(); ++i) {
+                if (!lanes[i].events.empty()) send(i);
+            }
+        }
+    };
+
+    struct InlineDepth {
+        InlineDepth() { ++inline_depth_; }
+        ~InlineDepth() { --inline_depth_; }
+    };
+
     std::unordered_map<size_t, Binding> bindings;
     std::mutex mtx;
+    std::atomic<EventRecorder*> recorder{nullptr};
+    std::atomic<LocalDispatch> local_mode{LocalDispatch::POST};
+    std::atomic<unsigned> max_inline_depth_{8};
+    std::atomic<uint64_t> epoch{next_epoch()};        // see next_epoch()
+    std::atomic<bool> track_load_{false};
+    std::unordered_map<size_t, std::shared_ptr<const FilterBase>> filters_;    // under mtx
+    std::atomic<size_t> filtered_tags_{0};
+    std::atomic<uint64_t> filtered_out_{0};
+
+    inline static thread_local unsigned inline_depth_ = 0;
+    static thread_local CachedFilter filter_cache_[kFilterSlots];
+    static thread_local ProducerBatch batch_;
 };
 
+inline thread_local CormanManager::CachedFilter CormanManager::filter_cache_[CormanManager::kFilterSlots];
+inline thread_local CormanManager::ProducerBatch CormanManager::batch_;
+
 // ---- Global Manager Instance ---- //
 inline CormanManager Corman;
 
@@ -0,0 +1,223 @@
+#ifndef OSKA_FUTURE_HPP
+#define OSKA_FUTURE_HPP
+
+// Lightweight future for CormanManager::call.
+//
+// The shared state (FutureSlot) is recycled through a per-result-type pool,
+// so a request/response round trip does not allocate once the pool is warm.
+// A slot is referenced by exactly two owners, the Future and the in-flight
+// request, and goes back to the pool when both have let go.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace oska {
+
+namespace detail {
+
+template <typename R>
+class FutureSlot {
+public:
+    enum State : uint32_t {
+        PENDING,
+        READY,
+        BROKEN     // the request was dropped without a reply
+    };
+
+    static FutureSlot* acquire();
+
+    template <typename V>
+    void complete(V&& v) {
+        value_.emplace(std::forward<V>(v));
+        finish(READY);
+    }
+
+    // Called by the request side if it is destroyed without completing.
+    void abandon() {
+        if (state_.load(std::memory_order_acquire) == PENDING) finish(BROKEN);
+        release();
+    }
+
+    void release() {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) recycle(this);
+    }
+
+    uint32_t state() const { return state_.load(std::memory_order_acquire); }
+
+    // Waits until the slot leaves PENDING or `deadline` passes.
+    template <typename Clock, typename Duration>
+    bool wait_until(const std::chrono::time_point<Clock, Duration>* deadline) {
+        if (state() != PENDING) return true;
+
+        std::unique_lock<std::mutex> lock(mtx_);
+        waiting_.store(true, std::memory_order_seq_cst);
+        auto done = [this] { return state_.load(std::memory_order_seq_cst) != PENDING; };
+        if (deadline) return cv_.wait_until(lock, *deadline, done);
+        cv_.wait(lock, done);
+        return true;
+    }
+
+    std::optional<R>& value() { return value_; }
+
+private:
+    void finish(State s) {
+        state_.store(s, std::memory_order_seq_cst);
+        if (waiting_.load(std::memory_order_seq_cst)) {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cv_.notify_all();
+        }
+    }
+
+    void reset() {
+        value_.reset();
+        state_.store(PENDING, std::memory_order_relaxed);
+        waiting_.store(false, std::memory_order_relaxed);
+        refs_.store(2, std::memory_order_relaxed);
+    }
+
+    static void recycle(FutureSlot* slot);
+
+    std::atomic<uint32_t> state_{PENDING};
+    std::atomic<uint32_t> refs_{2};
+    std::atomic<bool> waiting_{false};
+    std::optional<R> value_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+};
+
+// Bounded freelist of slots for one result type.
+template <typename R>
+class FutureSlotPool {
+public:
+    static constexpr size_t kMaxPooled = 1024;
+
+    static FutureSlotPool& instance() {
+        static FutureSlotPool pool;
+        return pool;
+    }
+
+    ~FutureSlotPool() {
+        for (auto* slot : free_) delete slot;
+    }
+
+    FutureSlot<R>* take() {
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            if (!free_.empty()) {
+                FutureSlot<R>* slot = free_.back();
+                free_.pop_back();
+                reused_++;
+                return slot;
+            }
+            allocated_++;
+        }
+        return new FutureSlot<R>();
+    }
+
+    void give(FutureSlot<R>* slot) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (free_.size() < kMaxPooled) {
+            free_.push_back(slot);
+            return;
+        }
+        lock.unlock();
+        delete slot;
+    }
+
+    size_t reused() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        return reused_;
+    }
+
+    size_t allocated() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        return allocated_;
+    }
+
+private:
+    std::vector<FutureSlot<R>*> free_;
+    size_t reused_ = 0;
+    size_t allocated_ = 0;
+    std::mutex mtx_;
+};
+
+template <typename R>
+FutureSlot<R>* FutureSlot<R>::acquire() {
+    FutureSlot<R>* slot = FutureSlotPool<R>::instance().take();
+    slot->reset();
+    return slot;
+}
+
+template <typename R>
+void FutureSlot<R>::recycle(FutureSlot* slot) {
+    slot->value_.reset();
+    FutureSlotPool<R>::instance().give(slot);
+}
+
+} // namespace detail
+
+// ---- Future ---- //
+template <typename R>
+class Future {
+public:
+    Future() = default;
+    explicit Future(detail::FutureSlot<R>* slot) : slot_(slot) {}
+
+    Future(Future&& other) noexcept : slot_(other.slot_) { other.slot_ = nullptr; }
+
+    Future& operator=(Future&& other) noexcept {
+        if (this != &other) {
+            if (slot_) slot_->release();
+            slot_ = other.slot_;
+            other.slot_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~Future() {
+        if (slot_) slot_->release();
+    }
+
+    Future(const Future&) = delete;
+    Future& operator=(const Future&) = delete;
+
+    bool valid() const { return slot_ != nullptr; }
+
+    // True once the reply arrived or the request was dropped.
+    bool ready() const { return slot_ && slot_->state() != detail::FutureSlot<R>::PENDING; }
+
+    void wait() {
+        if (!slot_) return;
+        slot_->template wait_until<std::chrono::steady_clock, std::chrono::steady_clock::duration>(nullptr);
+    }
+
+    template <typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period>& timeout) {
+        if (!slot_) return true;
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return slot_->wait_until(&deadline);
+    }
+
+    // The handler's return value, or nullopt if no handler was bound or the
+    // request was dropped. The future is empty afterwards.
+    std::optional<R> get() {
+        if (!slot_) return std::nullopt;
+        wait();
+        std::optional<R> result = std::move(slot_->value());
+        slot_->release();
+        slot_ = nullptr;
+        return result;
+    }
+
+private:
+    detail::FutureSlot<R>* slot_ = nullptr;
+};
+
+} // namespace oska
+
+#endif // OSKA_FUTURE_HPP
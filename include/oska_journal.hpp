@@ -0,0 +1,445 @@
+#ifndef OSKA_JOURNAL_HPP
+#define OSKA_JOURNAL_HPP
+
+// Append-only binary event journal and replay.
+//
+// File layout: a 64 byte FileHeader followed by frames of
+//     FrameHeader { id, ts_ns, len } + payload padded to 8 bytes.
+// `id` is event_id<E> and the payload is ArgsCodec<Args> output. The file is
+// pre-sized and mmap'ed, so appending is a memcpy into the page cache.
+//
+// By default frames are collected in a 64 KB buffer per thread and reach the
+// mapping on flush(), close() or when the buffer fills; a crash of the
+// writing process loses what the buffers still hold. Mode::WRITE_THROUGH
+// copies every frame into the mapping as it is recorded, so everything up to
+// the crash is in the file for a post-mortem, at the cost of one shared
+// atomic per frame. Either way, only sync() survives a machine crash.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "oska_events.hpp"
+
+namespace oska {
+
+namespace journal {
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t start_ns;
+    char pad[40];
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout");
+
+struct FrameHeader {
+    uint64_t id;
+    uint64_t ts_ns;
+    uint32_t len;
+    uint32_t reserved;
+};
+static_assert(sizeof(FrameHeader) == 24, "FrameHeader layout");
+
+constexpr char kMagic[8] = {'O', 'S', 'K', 'A', 'J', 'R', 'N', 'L'};
+constexpr uint32_t kVersion = 1;
+
+inline size_t frame_size(size_t payload) {
+    return sizeof(FrameHeader) + ((payload + 7) & ~size_t(7));
+}
+
+} // namespace journal
+
+// ---- Journal (writer) ---- //
+class Journal : public EventRecorder {
+public:
+    static constexpr size_t kThreadBuffer = 64 * 1024;
+
+    enum class Mode {
+        BUFFERED,           // per-thread buffers, moved to the mapping 64 KB at a time
+        WRITE_THROUGH       // every frame goes straight into the mapping
+    };
+
+    // The file is created (or truncated) and sized to `capacity` bytes up
+    // front. Frames that no longer fit are counted in dropped().
+    Journal(const std::string& path, size_t capacity = 64u << 20, Mode mode = Mode::BUFFERED)
+        : capacity_(capacity), mode_(mode), serial_(next_serial()) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) return;
+        if (::ftruncate(fd_, static_cast<off_t>(capacity_)) != 0) {
+            ::close(fd_);
+            fd_ = -1;
+            return;
+        }
+        void* map = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd_);
+            fd_ = -1;
+            return;
+        }
+        map_ = static_cast<char*>(map);
+
+        journal::FileHeader header{};
+        std::memcpy(header.magic, journal::kMagic, sizeof(header.magic));
+        header.version = journal::kVersion;
+        header.start_ns = trace::now_ns();
+        std::memcpy(map_, &header, sizeof(header));
+        tail_ = sizeof(header);
+        base_.store(map_, std::memory_order_release);
+    }
+
+    ~Journal() {
+        close();
+    }
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    bool is_open() const { return base_.load(std::memory_order_acquire) != nullptr; }
+
+    // Bytes reserved in the file so far, including the file header.
+    size_t size() const {
+        size_t t = tail_.load(std::memory_order_relaxed);
+        return t < capacity_ ? t : capacity_;
+    }
+
+    uint64_t recorded() const { return recorded_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // Safe to call while another thread closes the journal; frames recorded
+    // once close() has started are ignored.
+    void record(uint64_t id, size_t size, Encoder encode, const void* tuple) override {
+        Writer writer(*this);
+        if (!writer.open) return;
+
+        size_t need = journal::frame_size(size);
+        if (mode_ == Mode::WRITE_THROUGH) {
+            char* dst = reserve(need);
+            if (dst) write_frame(dst, id, size, encode, tuple);
+            else dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Buffer* buf = local_buffer();
+        std::unique_lock<std::mutex> lock(buf->mtx);
+
+        if (need > kThreadBuffer) {
+            flush_locked(*buf);
+            char* dst = reserve(need);
+            if (dst) write_frame(dst, id, size, encode, tuple);
+            else dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        if (buf->used + need > kThreadBuffer) {
+            flush_locked(*buf);
+        }
+        write_frame(buf->data.get() + buf->used, id, size, encode, tuple);
+        buf->used += need;
+    }
+
+    // Moves every thread's pending frames into the mapping.
+    void flush() {
+        std::unique_lock<std::mutex> lock(buffers_mtx_);
+        for (auto& buf : buffers_) {
+            std::unique_lock<std::mutex> buf_lock(buf->mtx);
+            flush_locked(*buf);
+        }
+    }
+
+    // msync()s the mapping; only needed to survive a machine crash.
+    void sync() {
+        Writer writer(*this);
+        if (!writer.open) return;
+        flush();
+        ::msync(map_, size(), MS_SYNC);
+    }
+
+    // Flushes, detaches the thread buffers and trims the file to its used
+    // size. Waits for record() and sync() calls already running on other
+    // threads; later ones do nothing.
+    void close() {
+        if (!base_.exchange(nullptr, std::memory_order_seq_cst)) return;
+        while (writers_.load(std::memory_order_seq_cst) != 0) std::this_thread::yield();
+
+        {
+            std::unique_lock<std::mutex> lock(buffers_mtx_);
+            for (auto& buf : buffers_) {
+                std::unique_lock<std::mutex> buf_lock(buf->mtx);
+                flush_locked(*buf);
+                buf->owner = nullptr;
+            }
+            buffers_.clear();
+        }
+
+        size_t used = size();
+        ::munmap(map_, capacity_);
+        map_ = nullptr;
+        if (::ftruncate(fd_, static_cast<off_t>(used)) != 0) {
+            // Leave the zero tail in place; readers stop at the first empty frame.
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+private:
+    // Held by record() and sync() while they use the mapping; close() unmaps
+    // it only once the last one is gone.
+    struct Writer {
+        explicit Writer(Journal& j) : journal(j) {
+            journal.writers_.fetch_add(1, std::memory_order_seq_cst);
+            open = journal.base_.load(std::memory_order_seq_cst) != nullptr;
+        }
+        ~Writer() { journal.writers_.fetch_sub(1, std::memory_order_release); }
+
+        Journal& journal;
+        bool open;
+    };
+
+    struct Buffer {
+        std::mutex mtx;
+        Journal* owner;
+        std::unique_ptr<char[]> data{new char[kThreadBuffer]};
+        size_t used = 0;
+
+        explicit Buffer(Journal* j) : owner(j) {}
+    };
+
+    // Per-thread buffers keyed by journal serial. A thread that exits hands
+    // whatever it still holds to its journal.
+    struct ThreadBuffers {
+        std::unordered_map<uint64_t, std::shared_ptr<Buffer>> map;
+        uint64_t last_serial = 0;
+        Buffer* last = nullptr;
+
+        ~ThreadBuffers() {
+            for (auto& entry : map) {
+                std::unique_lock<std::mutex> lock(entry.second->mtx);
+                if (entry.second->owner) entry.second->owner->flush_locked(*entry.second);
+            }
+        }
+    };
+
+    static uint64_t next_serial() {
+        static std::atomic<uint64_t> serial{0};
+        return ++serial;
+    }
+
+    Buffer* local_buffer() {
+        static thread_local ThreadBuffers tls;
+        if (tls.last_serial == serial_) return tls.last;
+
+        auto& slot = tls.map[serial_];
+        if (!slot) {
+            for (auto it = tls.map.begin(); it != tls.map.end();) {
+                if (!it->second) {
+                    ++it;
+                    continue;
+                }
+                bool detached;
+                {
+                    std::unique_lock<std::mutex> lock(it->second->mtx);
+                    detached = it->second->owner == nullptr;
+                }
+                if (detached) it = tls.map.erase(it);
+                else ++it;
+            }
+            slot = std::make_shared<Buffer>(this);
+            std::unique_lock<std::mutex> lock(buffers_mtx_);
+            buffers_.push_back(slot);
+        }
+        tls.last_serial = serial_;
+        tls.last = slot.get();
+        return tls.last;
+    }
+
+    char* reserve(size_t bytes) {
+        size_t at = tail_.fetch_add(bytes, std::memory_order_relaxed);
+        if (at + bytes > capacity_) {
+            return nullptr;
+        }
+        return map_ + at;
+    }
+
+    void flush_locked(Buffer& buf) {
+        if (buf.used == 0) return;
+
+        char* dst = reserve(buf.used);
+        if (dst) {
+            std::memcpy(dst, buf.data.get(), buf.used);
+        } else {
+            for (size_t off = 0; off < buf.used;) {
+                journal::FrameHeader h;
+                std::memcpy(&h, buf.data.get() + off, sizeof(h));
+                off += journal::frame_size(h.len);
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                recorded_.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+        buf.used = 0;
+    }
+
+    void write_frame(char* dst, uint64_t id, size_t size, Encoder encode, const void* tuple) {
+        journal::FrameHeader h{id, trace::now_ns(), static_cast<uint32_t>(size), 0};
+        std::memcpy(dst, &h, sizeof(h));
+        encode(tuple, dst + sizeof(h));
+        recorded_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    int fd_ = -1;
+    char* map_ = nullptr;                   // the mapping, until close() unmaps it
+    std::atomic<char*> base_{nullptr};      // map_ while open; cleared first by close()
+    std::atomic<uint32_t> writers_{0};      // record() and sync() calls in progress
+    size_t capacity_;
+    Mode mode_;
+    uint64_t serial_;
+    std::atomic<size_t> tail_{0};
+    std::atomic<uint64_t> recorded_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::vector<std::shared_ptr<Buffer>> buffers_;
+    std::mutex buffers_mtx_;
+};
+
+// ---- JournalReader ---- //
+class JournalReader {
+public:
+    struct Frame {
+        uint64_t id;
+        uint64_t ts_ns;
+        const char* payload;
+        uint32_t len;
+    };
+
+    explicit JournalReader(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(journal::FileHeader)) {
+            void* map = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (map != MAP_FAILED) {
+                base_ = static_cast<const char*>(map);
+                size_ = static_cast<size_t>(st.st_size);
+                std::memcpy(&header_, base_, sizeof(header_));
+                if (std::memcmp(header_.magic, journal::kMagic, sizeof(header_.magic)) != 0 ||
+                    header_.version != journal::kVersion) {
+                    ::munmap(const_cast<char*>(base_), size_);
+                    base_ = nullptr;
+                }
+            }
+        }
+        ::close(fd);
+    }
+
+    ~JournalReader() {
+        if (base_) ::munmap(const_cast<char*>(base_), size_);
+    }
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    bool is_open() const { return base_ != nullptr; }
+    uint64_t start_ns() const { return header_.start_ns; }
+
+    // Stops at the end of the file or the first empty (never written) frame.
+    template <typename F>
+    void for_each(F&& f) const {
+        if (!base_) return;
+        size_t off = sizeof(journal::FileHeader);
+        while (off + sizeof(journal::FrameHeader) <= size_) {
+            journal::FrameHeader h;
+            std::memcpy(&h, base_ + off, sizeof(h));
+            if (h.id == 0 || off + journal::frame_size(h.len) > size_) break;
+            f(Frame{h.id, h.ts_ns, base_ + off + sizeof(h), h.len});
+            off += journal::frame_size(h.len);
+        }
+    }
+
+private:
+    const char* base_ = nullptr;
+    size_t size_ = 0;
+    journal::FileHeader header_{};
+};
+
+// ---- Replayer ---- //
+class Replayer {
+public:
+    enum class Pacing {
+        FULL_SPEED,
+        ORIGINAL
+    };
+
+    struct Stats {
+        uint64_t replayed = 0;
+        uint64_t skipped = 0;   // unknown id or size mismatch
+    };
+
+    explicit Replayer(CormanManager& manager = Corman) : manager_(manager) {}
+
+    // Registers an event type so its frames are re-generated through gen().
+    template<typename EventTag>
+    void add() {
+        using Args = typename EventTraits<EventTag>::Args;
+        static_assert(ArgsCodec<Args>::packable,
+                      "Event arguments must be trivially copyable and hold no addresses");
+        static_assert(event_id<EventTag>::value != 0, "Event must be defined with OSKA_DEFINE_EVENT");
+
+        CormanManager* manager = &manager_;
+        decoders_[event_id<EventTag>::value] = [manager](const char* payload, uint32_t len) {
+            if (len != ArgsCodec<Args>::size) return false;
+            std::unique_ptr<Args> args(ArgsCodec<Args>::decode(payload));
+            std::apply([manager](auto&... a) { manager->template gen<EventTag>(a...); }, *args);
+            return true;
+        };
+    }
+
+    // Frames are written per thread, so they are put back into timestamp
+    // order (stable, so one thread's frames keep their order) before replay.
+    Stats run(const JournalReader& reader, Pacing pacing = Pacing::FULL_SPEED) {
+        std::vector<JournalReader::Frame> frames;
+        reader.for_each([&frames](const JournalReader::Frame& frame) { frames.push_back(frame); });
+        std::stable_sort(frames.begin(), frames.end(),
+            [](const JournalReader::Frame& a, const JournalReader::Frame& b) { return a.ts_ns < b.ts_ns; });
+
+        Stats stats;
+        auto start = std::chrono::steady_clock::now();
+
+        for (const auto& frame : frames) {
+            if (pacing == Pacing::ORIGINAL) {
+                std::this_thread::sleep_until(start + std::chrono::nanoseconds(frame.ts_ns - frames.front().ts_ns));
+            }
+
+            auto it = decoders_.find(frame.id);
+            if (it != decoders_.end() && it->second(frame.payload, frame.len)) {
+                stats.replayed++;
+            } else {
+                stats.skipped++;
+            }
+        }
+        return stats;
+    }
+
+private:
+    CormanManager& manager_;
+    std::unordered_map<uint64_t, std::function<bool(const char*, uint32_t)>> decoders_;
+};
+
+} // namespace oska
+
+#endif // OSKA_JOURNAL_HPP
@@ -0,0 +1,344 @@
+#ifndef OSKA_PIPELINE_HPP
+#define OSKA_PIPELINE_HPP
+
+// Stages over channels: map, filter, merge and split, each run by its own
+// worker threads.
+//
+//     Pipeline p;
+//     auto& lines = p.channel<std::string, 256>();
+//     auto& rows  = p.channel<Row, 256>();
+//     auto& good  = p.channel<Row, 256>();
+//     p.map("parse", lines, rows, parse_row, 4);               // ordered
+//     p.filter("valid", rows, good, [](const Row& r) { return r.ok; });
+//     p.start();
+//     ... feed `lines`, then lines.close() ...
+//     p.wait();
+//
+// Any channel with the Channel<Type, N> interface works (Channel,
+// ShardedChannel, RecyclingChannel). A stage closes its output(s) once its
+// input is closed and drained by all of its workers; if an output is closed
+// underneath it, the stage closes its input so upstream producers unblock
+// too. Items are passed on as the unique_ptr the input channel handed out,
+// so filter and split stages never copy.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "channel.hpp"
+
+namespace oska {
+
+// Element type of a channel, taken from what get() returns.
+template <typename Ch>
+using channel_value_t = typename decltype(std::declval<Ch&>().get())::element_type;
+
+class Pipeline {
+public:
+    enum class Order {
+        ORDERED,     // outputs leave in input order
+        UNORDERED    // outputs leave as soon as they are ready
+    };
+
+    struct StageStats {
+        std::string name;
+        size_t workers;
+        uint64_t in;          // items taken from the input(s)
+        uint64_t out;         // items handed to the output(s)
+        uint64_t busy_ns;     // summed over workers, user code only
+        uint64_t elapsed_ns;  // start() until the last worker finished (or now)
+        bool done;
+
+        double per_second() const {
+            return elapsed_ns ? static_cast<double>(out) * 1e9 / static_cast<double>(elapsed_ns) : 0.0;
+        }
+    };
+
+    Pipeline() = default;
+
+    // Joins the workers; inputs have to be closed for this to return.
+    ~Pipeline() { wait(); }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    // A channel owned by the pipeline, alive as long as the pipeline is.
+    template <typename Type, size_t N>
+    Channel<Type, N>& channel() {
+        auto channel = std::make_shared<Channel<Type, N>>();
+        Channel<Type, N>& ref = *channel;
+        owned_.push_back(std::move(channel));
+        return ref;
+    }
+
+    // ---- Stages ---- //
+    // out.add(fn(item)) for every item, with `workers` threads. ORDERED keeps
+    // at most `4 * workers` finished results waiting for a slow predecessor.
+    template <typename In, typename Out, typename Fn>
+    void map(const std::string& name, In& in, Out& out, Fn fn, size_t workers = 1, Order order = Order::ORDERED) {
+        Stage& stage = add_stage(name, workers);
+        stage.on_done = [&out] { out.close(); };
+
+        if (order == Order::UNORDERED || workers == 1) {
+            for (size_t w = 0; w < stage.workers; ++w) {
+                stage.bodies.push_back([&stage, &in, &out, fn]() mutable {
+                    while (auto item = in.get()) {
+                        stage.in.fetch_add(1, std::memory_order_relaxed);
+                        uint64_t t0 = now_ns();
+                        auto value = fn(*item);
+                        stage.busy_ns.fetch_add(now_ns() - t0, std::memory_order_relaxed);
+                        if (out.add(std::move(value)) != ChannelBase::Result::OK) {
+                            in.close();
+                            break;
+                        }
+                        stage.out.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            }
+            return;
+        }
+
+        using OutT = std::decay_t<std::invoke_result_t<Fn&, channel_value_t<In>&>>;
+        auto reorder = std::make_shared<Reorder<OutT>>();
+        size_t window = 4 * stage.workers;
+        for (size_t w = 0; w < stage.workers; ++w) {
+            stage.bodies.push_back([&stage, &in, &out, fn, reorder, window]() mutable {
+                for (;;) {
+                    uint64_t seq;
+                    std::unique_ptr<channel_value_t<In>> item;
+                    {
+                        // Sequence numbers follow the order items leave `in`.
+                        std::unique_lock<std::mutex> lock(reorder->read_mtx);
+                        item = in.get();
+                        if (!item) break;
+                        seq = reorder->next_seq++;
+                    }
+                    stage.in.fetch_add(1, std::memory_order_relaxed);
+
+                    uint64_t t0 = now_ns();
+                    OutT value = fn(*item);
+                    stage.busy_ns.fetch_add(now_ns() - t0, std::memory_order_relaxed);
+
+                    std::unique_lock<std::mutex> lock(reorder->mtx);
+                    reorder->cv.wait(lock, [&] { return reorder->stop || seq - reorder->next_emit < window; });
+                    if (reorder->stop) break;
+                    reorder->ready.emplace(seq, std::move(value));
+
+                    // Whoever completes the next result in line emits the run.
+                    auto it = reorder->ready.begin();
+                    while (it != reorder->ready.end() && it->first == reorder->next_emit) {
+                        if (out.add(std::move(it->second)) != ChannelBase::Result::OK) {
+                            reorder->stop = true;
+                            in.close();
+                            break;
+                        }
+                        stage.out.fetch_add(1, std::memory_order_relaxed);
+                        it = reorder->ready.erase(it);
+                        reorder->next_emit++;
+                    }
+                    reorder->cv.notify_all();
+                }
+            });
+        }
+    }
+
+    // Passes on the items `pred` accepts. With several workers the order is
+    // not kept.
+    template <typename In, typename Out, typename Pred>
+    void filter(const std::string& name, In& in, Out& out, Pred pred, size_t workers = 1) {
+        Stage& stage = add_stage(name, workers);
+        stage.on_done = [&out] { out.close(); };
+        for (size_t w = 0; w < stage.workers; ++w) {
+            stage.bodies.push_back([&stage, &in, &out, pred]() mutable {
+                while (auto item = in.get()) {
+                    stage.in.fetch_add(1, std::memory_order_relaxed);
+                    uint64_t t0 = now_ns();
+                    bool keep = pred(static_cast<const channel_value_t<In>&>(*item));
+                    stage.busy_ns.fetch_add(now_ns() - t0, std::memory_order_relaxed);
+                    if (!keep) continue;
+                    if (out.add_ptr(std::move(item)) != ChannelBase::Result::OK) {
+                        in.close();
+                        break;
+                    }
+                    stage.out.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+    }
+
+    // One worker per input; `out` is closed after the last input closes.
+    template <typename In, typename Out>
+    void merge(const std::string& name, std::vector<In*> ins, Out& out) {
+        Stage& stage = add_stage(name, ins.size());
+        stage.on_done = [&out] { out.close(); };
+        for (In* in : ins) {
+            stage.bodies.push_back([&stage, in, &out] {
+                while (auto item = in->get()) {
+                    stage.in.fetch_add(1, std::memory_order_relaxed);
+                    if (out.add_ptr(std::move(item)) != ChannelBase::Result::OK) {
+                        in->close();
+                        break;
+                    }
+                    stage.out.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+    }
+
+    // Deals items to `outs` in turn.
+    template <typename In, typename Out>
+    void split(const std::string& name, In& in, std::vector<Out*> outs) {
+        size_t next = 0;
+        splitter(name, in, std::move(outs), [next](const channel_value_t<In>&, size_t n) mutable {
+            return next++ % n;
+        });
+    }
+
+    // Sends every item with the same key to the same output.
+    template <typename In, typename Out, typename KeyFn>
+    void split_by_key(const std::string& name, In& in, std::vector<Out*> outs, KeyFn key) {
+        splitter(name, in, std::move(outs), [key](const channel_value_t<In>& item, size_t n) mutable {
+            auto k = key(item);
+            return std::hash<decltype(k)>()(k) % n;
+        });
+    }
+
+    // ---- Running ---- //
+    void start() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        uint64_t t0 = now_ns();
+        for (auto& stage : stages_) {
+            if (stage->started) continue;
+            stage->started = true;
+            stage->start_ns = t0;
+            stage->running.store(stage->bodies.size(), std::memory_order_relaxed);
+            if (stage->bodies.empty()) finish(*stage);
+            for (auto& body : stage->bodies) {
+                Stage* s = stage.get();
+                threads_.emplace_back([this, s, &body] {
+                    body();
+                    if (s->running.fetch_sub(1, std::memory_order_acq_rel) == 1) finish(*s);
+                });
+            }
+        }
+    }
+
+    void wait() {
+        std::vector<std::thread> threads;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            threads.swap(threads_);
+        }
+        for (auto& t : threads) t.join();
+    }
+
+    std::vector<StageStats> stats() const {
+        std::unique_lock<std::mutex> lock(mtx_);
+        std::vector<StageStats> out;
+        uint64_t now = now_ns();
+        for (const auto& stage : stages_) {
+            uint64_t end = stage->end_ns.load(std::memory_order_acquire);
+            bool done = end != 0;
+            out.push_back(StageStats{stage->name, stage->workers,
+                                     stage->in.load(std::memory_order_relaxed),
+                                     stage->out.load(std::memory_order_relaxed),
+                                     stage->busy_ns.load(std::memory_order_relaxed),
+                                     stage->started ? (done ? end : now) - stage->start_ns : 0,
+                                     done});
+        }
+        return out;
+    }
+
+private:
+    struct Stage {
+        std::string name;
+        size_t workers;
+        std::vector<std::function<void()>> bodies;
+        std::function<void()> on_done;
+        bool started = false;
+        uint64_t start_ns = 0;
+
+        std::atomic<size_t> running{0};
+        std::atomic<uint64_t> end_ns{0};
+        std::atomic<uint64_t> in{0};
+        std::atomic<uint64_t> out{0};
+        std::atomic<uint64_t> busy_ns{0};
+    };
+
+    template <typename OutT>
+    struct Reorder {
+        std::mutex read_mtx;
+        uint64_t next_seq = 0;
+
+        std::mutex mtx;
+        std::condition_variable cv;
+        uint64_t next_emit = 0;
+        bool stop = false;
+        std::map<uint64_t, OutT> ready;
+    };
+
+    static uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    Stage& add_stage(const std::string& name, size_t workers) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        stages_.push_back(std::make_unique<Stage>());
+        Stage& stage = *stages_.back();
+        stage.name = name;
+        stage.workers = workers ? workers : 1;
+        return stage;
+    }
+
+    void finish(Stage& stage) {
+        stage.end_ns.store(now_ns(), std::memory_order_release);
+        if (stage.on_done) stage.on_done();
+    }
+
+    // Single worker, so `pick` may keep state.
+    template <typename In, typename Out, typename Pick>
+    void splitter(const std::string& name, In& in, std::vector<Out*> outs, Pick pick) {
+        Stage& stage = add_stage(name, 1);
+        stage.on_done = [outs] {
+            for (Out* out : outs) out->close();
+        };
+        stage.bodies.push_back([&stage, &in, outs, pick]() mutable {
+            std::vector<bool> gone(outs.size(), false);
+            size_t open = outs.size();
+            while (open > 0) {
+                auto item = in.get();
+                if (!item) break;
+                stage.in.fetch_add(1, std::memory_order_relaxed);
+                size_t i = pick(*item, outs.size());
+                if (gone[i]) continue;   // that branch was closed downstream
+                if (outs[i]->add_ptr(std::move(item)) != ChannelBase::Result::OK) {
+                    gone[i] = true;
+                    open--;
+                    continue;
+                }
+                stage.out.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (open == 0) in.close();
+        });
+    }
+
+    mutable std::mutex mtx_;
+    std::vector<std::unique_ptr<Stage>> stages_;
+    std::vector<std::shared_ptr<void>> owned_;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace oska
+
+#endif // OSKA_PIPELINE_HPP
@@ -0,0 +1,497 @@
+#ifndef OSKA_PRIORITY_LOOP_HPP
+#define OSKA_PRIORITY_LOOP_HPP
+
+// EventLoop with one bounded ring per Priority lane.
+//
+// Events declared with OSKA_DEFINE_PRIORITY_EVENT land in their own lane, so
+// a deep BULK backlog never sits in front of a HIGH event. Lanes are drained
+// either strictly by priority or by weight (up to `weight[lane]` events per
+// lane per round). In both modes a non-empty lane that has been passed over
+// `starvation_limit` times in a row is served next.
+//
+// With Options::deadlines set to EDF, events sent with gen_with_deadline()
+// bypass the lanes and are served earliest deadline first, ahead of every
+// lane whose priority is not above that of the most urgent deadline event
+// queued; a HIGH event without a deadline still goes before a backlog of
+// NORMAL deadline events. Lanes also keep their starvation limit. An event
+// that is taken after its deadline is dropped or handed to `on_expired`
+// instead of being handled.
+// Events without a deadline keep plain FIFO order within their lane.
+//
+// Events the loop's own thread posts to it (a handler that gen()s into its
+// own loop, LocalDispatch::LOCAL_QUEUE, producer batching flushed after a
+// handler) never wait for room: they go to an unbounded per-lane local
+// queue, served ahead of the lane's ring. Only the loop thread frees ring
+// slots, so blocking there would stop the loop for good.
+//
+// Options::placement pins the thread that calls run() and puts the lane rings
+// on the placement's NUMA node.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "oska_events.hpp"
+#include "oska_topology.hpp"
+
+namespace oska {
+
+class PriorityEventLoop : public EventLoopInterface {
+public:
+    enum class Drain {
+        STRICT,
+        WEIGHTED
+    };
+
+    enum class Deadlines {
+        IGNORE,     // deadline events are queued like any other
+        EDF         // earliest deadline first, expired events not handled
+    };
+
+    enum class Expired {
+        DROP,       // free the event's payload and count it
+        DIVERT      // hand it to Options::on_expired, which owns the payload
+    };
+
+    struct Options {
+        Drain drain = Drain::STRICT;
+        std::array<size_t, kPriorityLanes> capacity = {{256, 1024, 4096}};
+        std::array<uint32_t, kPriorityLanes> weight = {{16, 4, 1}};
+        uint32_t starvation_limit = 64;
+        Deadlines deadlines = Deadlines::IGNORE;
+        size_t deadline_capacity = 4096;
+        Expired expired = Expired::DROP;
+        // Runs on the loop thread; release the payload with discard_event().
+        std::function<void(const EventWrapper&)> on_expired;
+        Placement placement;
+    };
+
+    struct LaneStats {
+        uint64_t posted;
+        uint64_t handled;
+        uint64_t promoted;      // served because of the starvation limit
+        uint64_t local;         // posted from the loop's own thread
+        size_t max_depth;
+    };
+
+    struct DeadlineStats {
+        uint64_t posted;
+        uint64_t handled;       // ran before their deadline
+        uint64_t dropped;       // expired, payload freed
+        uint64_t diverted;      // expired, passed to on_expired
+        size_t max_depth;
+    };
+
+    static constexpr size_t kMaxRun = 256;      // events per batch handler call
+
+    explicit PriorityEventLoop(const std::string& name = "priority")
+        : PriorityEventLoop(Options(), name) {}
+
+    explicit PriorityEventLoop(Options options, const std::string& name = "priority")
+        : tracer(name), options_(options) {
+        Alloc alloc(topo::node_for(options_.placement));
+        for (size_t i = 0; i < kPriorityLanes; ++i) {
+            lanes_[i].ring = Ring(options_.capacity[i] ? options_.capacity[i] : 1, EventWrapper(), alloc);
+            credit_[i] = options_.weight[i];
+        }
+        if (options_.deadline_capacity == 0) options_.deadline_capacity = 1;
+        if (options_.deadlines == Deadlines::EDF) {
+            deadline_heap_ = Ring(alloc);
+            deadline_heap_.reserve(options_.deadline_capacity);
+        }
+    }
+
+    // ---- EventLoopInterface ---- //
+    void post(size_t tag, void* data) override {
+        post(EventWrapper(tag, data));
+    }
+
+    // Blocks while the event's lane is full, like Channel::add, unless called
+    // from the loop's own thread. Events posted after stop() are discarded.
+    void post(const EventWrapper& ev) override {
+        if (current() == this) {
+            post_local(ev);
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mtx_);
+        bool queued = enqueue(lock, ev);
+        lock.unlock();
+
+        if (!queued) discard_event(ev);
+
+        not_empty_.notify_one();
+    }
+
+    void post_batch(const EventWrapper* evs, size_t count) override {
+        if (current() == this) {
+            for (size_t i = 0; i < count; ++i) post_local(evs[i]);
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mtx_);
+        size_t queued = 0;
+        while (queued < count && enqueue(lock, evs[queued])) queued++;
+        lock.unlock();
+
+        for (size_t i = queued; i < count; ++i) discard_event(evs[i]);
+
+        not_empty_.notify_one();
+    }
+
+    // Loop thread only. Queues without waiting for room, ahead of what other
+    // threads have queued in the same lane; deadline events go into the heap
+    // past deadline_capacity.
+    bool post_local(const EventWrapper& ev) override {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (stop_) {
+            lock.unlock();
+            discard_event(ev);
+            return true;
+        }
+        if (options_.deadlines == Deadlines::EDF && ev.deadline_ns != 0) {
+            push_deadline(ev);
+            return true;
+        }
+        Lane& lane = lanes_[lane_of(ev)];
+        lane.local.push_back(ev);
+        lane.posted++;
+        lane.local_posted++;
+        if (lane.queued() > lane.max_depth) lane.max_depth = lane.queued();
+        return true;
+    }
+
+    void run_inline(const EventWrapper& ev, const Callback& cb) override {
+        HandlerProbe probe(this, ev.tag, 0, ev.data);
+        trace::HandlerScope scope(tracer, ev);
+        cb(ev.data);
+    }
+
+    void connect(size_t tag, Callback cb) override {
+        callbacks[tag] = cb;
+        batch_callbacks.erase(tag);
+    }
+
+    void disconnect(size_t tag) override {
+        callbacks.erase(tag);
+        batch_callbacks.erase(tag);
+    }
+
+    // Runs are taken from the head of one lane; in WEIGHTED mode every event
+    // after the first spends one of the lane's credits.
+    bool connect_batch(size_t tag, BatchCallback cb) override {
+        batch_callbacks[tag] = cb;
+        return true;
+    }
+
+    bool accepts_tasks() const override { return true; }
+
+    size_t backlog() override {
+        std::unique_lock<std::mutex> lock(mtx_);
+        return total_size();
+    }
+
+    void run() override {
+        RunScope scope(this);
+        topo::apply(options_.placement);
+        for (;;) {
+            EventWrapper ev;
+            bool expired = false;
+            const BatchCallback* batch = nullptr;
+            size_t depth = 0;
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                not_empty_.wait(lock, [this] { return stop_ || total_size() > 0; });
+                if (total_size() == 0) return;
+
+                size_t lane = pick();
+                if (lane == kDeadlineLane) {
+                    std::pop_heap(deadline_heap_.begin(), deadline_heap_.end(), later_deadline);
+                    ev = deadline_heap_.back();
+                    deadline_heap_.pop_back();
+                    deadline_lanes_[lane_of(ev)]--;
+                    expired = trace::now_ns() > ev.deadline_ns;
+                    if (!expired) deadline_.handled++;
+                    else if (options_.expired == Expired::DIVERT && options_.on_expired) deadline_.diverted++;
+                    else deadline_.dropped++;
+                    deadline_not_full_.notify_one();
+                } else {
+                    Lane& l = lanes_[lane];
+                    size_t freed = 0;
+                    ev = take(l, freed);
+
+                    auto it = batch_callbacks.empty() ? batch_callbacks.end() : batch_callbacks.find(ev.tag);
+                    if (it != batch_callbacks.end()) {
+                        batch = &it->second;
+                        run_data_.clear();
+                        run_data_.push_back(ev.data);
+                        while (l.queued() > 0 && front(l).tag == ev.tag && run_data_.size() < kMaxRun &&
+                               (options_.drain == Drain::STRICT || credit_[lane] > 0)) {
+                            if (options_.drain != Drain::STRICT) credit_[lane]--;
+                            run_data_.push_back(take(l, freed).data);
+                        }
+                    }
+                    if (freed > 1) l.not_full.notify_all();
+                    else if (freed == 1) l.not_full.notify_one();
+                }
+                depth = total_size();
+            }
+
+            if (batch) {
+                {
+                    HandlerProbe probe(this, ev.tag, depth, ev.data);
+                    trace::HandlerScope scope(tracer, ev);
+                    (*batch)(run_data_.data(), run_data_.size());
+                }
+                CormanManager::flush();
+                continue;
+            }
+
+            if (expired) {
+                if (options_.expired == Expired::DIVERT && options_.on_expired) options_.on_expired(ev);
+                else discard_event(ev);
+                continue;
+            }
+
+            if (run_task(ev)) {
+                CormanManager::flush();
+                continue;
+            }
+            auto it = callbacks.find(ev.tag);
+            if (it == callbacks.end()) {
+                discard_event(ev);
+            } else {
+                {
+                    HandlerProbe probe(this, ev.tag, depth, ev.data);
+                    trace::HandlerScope scope(tracer, ev);
+                    it->second(ev.data);
+                }
+                CormanManager::flush();
+            }
+        }
+    }
+
+    // run() returns once every lane is empty; later posts are discarded.
+    void stop() {
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        not_empty_.notify_all();
+        for (auto& lane : lanes_) lane.not_full.notify_all();
+        deadline_not_full_.notify_all();
+    }
+
+    LaneStats stats(Priority priority) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        const Lane& l = lanes_[static_cast<size_t>(priority)];
+        return {l.posted, l.handled, l.promoted, l.local_posted, l.max_depth};
+    }
+
+    DeadlineStats deadline_stats() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        return deadline_;
+    }
+
+    size_t depth(Priority priority) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        return lanes_[static_cast<size_t>(priority)].queued();
+    }
+
+    trace::LoopTracer tracer;
+
+private:
+    using Alloc = topo::NodeAllocator<EventWrapper>;
+    using Ring = std::vector<EventWrapper, Alloc>;
+
+    struct Lane {
+        Ring ring;
+        size_t head = 0;
+        size_t size = 0;                    // events in the ring
+        std::deque<EventWrapper> local;     // from the loop thread, unbounded
+        uint32_t skipped = 0;
+        std::condition_variable not_full;
+
+        uint64_t posted = 0;
+        uint64_t handled = 0;
+        uint64_t promoted = 0;
+        uint64_t local_posted = 0;
+        size_t max_depth = 0;
+
+        size_t queued() const { return size + local.size(); }
+    };
+
+    // pick() result for the deadline heap.
+    static constexpr size_t kDeadlineLane = kPriorityLanes;
+
+    // Heap order for std::push_heap: the root is the earliest deadline.
+    static bool later_deadline(const EventWrapper& a, const EventWrapper& b) {
+        return a.deadline_ns > b.deadline_ns;
+    }
+
+    // Next event of a lane, local queue first; called with mtx_ held.
+    const EventWrapper& front(const Lane& l) const {
+        return l.local.empty() ? l.ring[l.head] : l.local.front();
+    }
+
+    // Removes front(l); `freed` counts the ring slots given back.
+    EventWrapper take(Lane& l, size_t& freed) {
+        EventWrapper ev;
+        if (!l.local.empty()) {
+            ev = l.local.front();
+            l.local.pop_front();
+        } else {
+            ev = l.ring[l.head];
+            l.head = (l.head + 1) % l.ring.size();
+            l.size--;
+            freed++;
+        }
+        l.handled++;
+        return ev;
+    }
+
+    void push_deadline(const EventWrapper& ev) {
+        deadline_heap_.push_back(ev);
+        std::push_heap(deadline_heap_.begin(), deadline_heap_.end(), later_deadline);
+        deadline_lanes_[lane_of(ev)]++;
+        deadline_.posted++;
+        if (deadline_heap_.size() > deadline_.max_depth) deadline_.max_depth = deadline_heap_.size();
+    }
+
+    // Queues `ev` with mtx_ held, waiting for room if needed; false once
+    // stopped (the event is not queued).
+    bool enqueue(std::unique_lock<std::mutex>& lock, const EventWrapper& ev) {
+        if (options_.deadlines == Deadlines::EDF && ev.deadline_ns != 0) {
+            if (deadline_heap_.size() >= options_.deadline_capacity) {
+                // Let the loop make room before blocking.
+                lock.unlock();
+                not_empty_.notify_one();
+                lock.lock();
+                deadline_not_full_.wait(lock, [&] { return stop_ || deadline_heap_.size() < options_.deadline_capacity; });
+            }
+            if (stop_) return false;
+            push_deadline(ev);
+            return true;
+        }
+
+        Lane& lane = lanes_[lane_of(ev)];
+        if (lane.size == lane.ring.size()) {
+            lock.unlock();
+            not_empty_.notify_one();
+            lock.lock();
+            lane.not_full.wait(lock, [&] { return stop_ || lane.size < lane.ring.size(); });
+        }
+        if (stop_) return false;
+        lane.ring[(lane.head + lane.size) % lane.ring.size()] = ev;
+        lane.size++;
+        lane.posted++;
+        if (lane.queued() > lane.max_depth) lane.max_depth = lane.queued();
+        return true;
+    }
+
+    static size_t lane_of(const EventWrapper& ev) {
+        size_t lane = static_cast<size_t>(ev.priority);
+        return lane < kPriorityLanes ? lane : kPriorityLanes - 1;
+    }
+
+    size_t total_size() const {
+        size_t n = deadline_heap_.size();
+        for (const auto& lane : lanes_) n += lane.queued();
+        return n;
+    }
+
+    // Chooses the lane to serve next, or kDeadlineLane; called with mtx_ held
+    // and work pending.
+    size_t pick() {
+        size_t chosen = kPriorityLanes;
+
+        // Starving lanes first, highest priority among them.
+        for (size_t i = 0; i < kPriorityLanes; ++i) {
+            if (lanes_[i].queued() > 0 && options_.starvation_limit && lanes_[i].skipped >= options_.starvation_limit) {
+                chosen = i;
+                lanes_[i].promoted++;
+                break;
+            }
+        }
+
+        // Deadline events come before the lanes unless a lane is starving or
+        // has a higher priority than any of them.
+        if (chosen == kPriorityLanes && !deadline_heap_.empty() && !outranks_deadlines()) {
+            for (auto& lane : lanes_) {
+                if (lane.queued() > 0) lane.skipped++;
+            }
+            return kDeadlineLane;
+        }
+
+        if (chosen == kPriorityLanes) {
+            if (options_.drain == Drain::STRICT) {
+                for (size_t i = 0; i < kPriorityLanes && chosen == kPriorityLanes; ++i) {
+                    if (lanes_[i].queued() > 0) chosen = i;
+                }
+            } else {
+                chosen = pick_weighted();
+            }
+        }
+
+        for (size_t i = 0; i < kPriorityLanes; ++i) {
+            if (i == chosen) lanes_[i].skipped = 0;
+            else if (lanes_[i].queued() > 0) lanes_[i].skipped++;
+        }
+        return chosen;
+    }
+
+    // True if a non-empty lane has a higher priority than every queued
+    // deadline event.
+    bool outranks_deadlines() const {
+        for (size_t i = 0; i < kPriorityLanes; ++i) {
+            if (deadline_lanes_[i] > 0) return false;
+            if (lanes_[i].queued() > 0) return true;
+        }
+        return false;
+    }
+
+    // Deficit round robin over the non-empty lanes.
+    size_t pick_weighted() {
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_t i = 0; i < kPriorityLanes; ++i) {
+                if (lanes_[i].queued() > 0 && credit_[i] > 0) {
+                    credit_[i]--;
+                    return i;
+                }
+            }
+            for (size_t i = 0; i < kPriorityLanes; ++i) {
+                credit_[i] = options_.weight[i] ? options_.weight[i] : 1;
+            }
+        }
+        for (size_t i = 0; i < kPriorityLanes; ++i) {
+            if (lanes_[i].queued() > 0) return i;
+        }
+        return 0;
+    }
+
+    Options options_;
+    std::array<Lane, kPriorityLanes> lanes_;
+    std::array<uint32_t, kPriorityLanes> credit_{};
+    std::mutex mtx_;
+    std::condition_variable not_empty_;
+    bool stop_ = false;
+
+    Ring deadline_heap_;
+    std::array<size_t, kPriorityLanes> deadline_lanes_{};   // heap events per priority
+    std::condition_variable deadline_not_full_;
+    DeadlineStats deadline_{};
+
+    std::unordered_map<size_t, Callback> callbacks;
+    std::unordered_map<size_t, BatchCallback> batch_callbacks;
+    std::vector<void*> run_data_;            // loop thread only
+};
+
+} // namespace oska
+
+#endif // OSKA_PRIORITY_LOOP_HPP
@@ -0,0 +1,71 @@
+#ifndef OSKA_PROBES_HPP
+#define OSKA_PROBES_HPP
+
+// Static tracepoints (USDT) for perf and bpftrace.
+//
+// Build with OSKA_USDT defined (cmake -DOSKA_USDT=ON, needs <sys/sdt.h> from
+// systemtap-sdt) to compile them in. Each probe is then a single nop in the
+// code plus an ELF note, and costs nothing until a tracer attaches; without
+// OSKA_USDT the macros expand to nothing. Probes, all in provider `oska`:
+//
+//   gen(tag, data, deadline_ns)          CormanManager built an event
+//   dispatch(tag, data, loop)            ... and routed it to `loop`
+//   undelivered(tag, data)               ... no binding; the payload is freed
+//   filtered(tag)                        ... a filter rejected it
+//   handler__entry(loop, tag, depth, data)   `depth` events still queued behind it
+//   handler__exit(loop, tag)
+//   channel__add(channel, depth)         item queued; `depth` items now queued
+//   channel__get(channel, depth)         item taken; `depth` items left
+//   channel__close(channel)
+//   channel__wait__start(channel, side)  add (side 1) or get (side 0) blocks
+//   channel__wait__end(channel, side, result)
+//   channel__contended(channel)          the channel's mutex was already held
+//
+// `tag` is the TypeId value the loops see; `data` identifies one event from
+// gen() to its handler. Sample scripts are in tools/bpftrace.
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef OSKA_USDT
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#else
+#error "OSKA_USDT needs <sys/sdt.h> (systemtap-sdt-dev / systemtap-sdt-devel)"
+#endif
+
+#define OSKA_PROBE1(name, a) DTRACE_PROBE1(oska, name, a)
+#define OSKA_PROBE2(name, a, b) DTRACE_PROBE2(oska, name, a, b)
+#define OSKA_PROBE3(name, a, b, c) DTRACE_PROBE3(oska, name, a, b, c)
+#define OSKA_PROBE4(name, a, b, c, d) DTRACE_PROBE4(oska, name, a, b, c, d)
+#else
+#define OSKA_PROBE1(name, a) do {} while (0)
+#define OSKA_PROBE2(name, a, b) do {} while (0)
+#define OSKA_PROBE3(name, a, b, c) do {} while (0)
+#define OSKA_PROBE4(name, a, b, c, d) do {} while (0)
+#endif
+
+namespace oska {
+
+// Fires handler__entry and handler__exit around a loop's handler call.
+class HandlerProbe {
+public:
+    HandlerProbe(const void* loop, size_t tag, size_t depth, const void* data) : loop_(loop), tag_(tag) {
+        OSKA_PROBE4(handler__entry, loop, tag, depth, data);
+        (void)depth;
+        (void)data;
+    }
+
+    ~HandlerProbe() { OSKA_PROBE2(handler__exit, loop_, tag_); }
+
+    HandlerProbe(const HandlerProbe&) = delete;
+    HandlerProbe& operator=(const HandlerProbe&) = delete;
+
+private:
+    [[maybe_unused]] const void* loop_;
+    [[maybe_unused]] size_t tag_;
+};
+
+} // namespace oska
+
+#endif // OSKA_PROBES_HPP
@@ -0,0 +1,406 @@
+#ifndef OSKA_REMOTE_HPP
+#define OSKA_REMOTE_HPP
+
+// Events between local processes over a Unix domain stream socket.
+//
+// The sending process binds events to a RemoteEventLoop instead of a local
+// loop; the receiving process runs a RemoteEventServer that re-generates them
+// through its own CormanManager, so they reach whatever local loop the event
+// is connected to there:
+//
+//     // sender                                // receiver
+//     RemoteEventLoop remote("/run/svc.sock");  RemoteEventServer server("/run/svc.sock");
+//     remote.bind<EvOrder>();                   server.accept<EvOrder>();
+//     std::thread t([&] { remote.run(); });     Corman.connect<EvOrder>(&loop, on_order);
+//     Corman.gen<EvOrder>(id, qty);             std::thread t([&] { server.run(); });
+//
+// Frames use the journal layout (journal::FrameHeader + ArgsCodec payload
+// padded to 8 bytes), keyed by event_id, so only named events with trivially
+// copyable arguments that hold no addresses can cross (remote::sendable). Posting only appends to a buffer; run()
+// sends everything queued since the last send with a single sendmsg().
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "oska_events.hpp"
+#include "oska_journal.hpp"
+
+namespace oska {
+
+namespace remote {
+
+inline bool make_address(const std::string& path, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Whether EventTag may cross to another process. Pointer and view arguments
+// would arrive as addresses in the sender's address space; bind() and
+// accept() refuse them at compile time.
+template<typename EventTag>
+inline constexpr bool sendable = ArgsCodec<typename EventTraits<EventTag>::Args>::packable &&
+                                 event_id<EventTag>::value != 0 && !is_query_event<EventTag>::value;
+
+} // namespace remote
+
+// ---- Sending side ---- //
+class RemoteEventLoop : public EventLoopInterface {
+public:
+    struct Stats {
+        uint64_t events;    // encoded into the send buffer
+        uint64_t sends;     // sendmsg() batches
+        uint64_t bytes;
+        uint64_t dropped;   // unbound tag, or the connection is gone
+    };
+
+    // Connects right away; check is_open(). Producers block once
+    // `max_pending` bytes are waiting to be sent.
+    explicit RemoteEventLoop(const std::string& path, size_t max_pending = 1u << 20)
+        : max_pending_(max_pending) {
+        sockaddr_un addr;
+        if (!remote::make_address(path, addr)) return;
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) return;
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    ~RemoteEventLoop() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    RemoteEventLoop(const RemoteEventLoop&) = delete;
+    RemoteEventLoop& operator=(const RemoteEventLoop&) = delete;
+
+    bool is_open() const { return fd_ >= 0; }
+
+    // Routes EventTag to the other process. The local handler never runs.
+    template<typename EventTag>
+    void bind(CormanManager& manager = Corman) {
+        using Args = typename EventTraits<EventTag>::Args;
+        static_assert(ArgsCodec<Args>::packable,
+                      "Remote event arguments must be trivially copyable and hold no addresses");
+        static_assert(event_id<EventTag>::value != 0, "Remote events must be defined with OSKA_DEFINE_EVENT");
+        static_assert(!is_query_event<EventTag>::value, "Query events cannot be sent to another process");
+
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            codecs_[TypeId<EventTag>::value()] = Codec{event_id<EventTag>::value, ArgsCodec<Args>::size,
+                                                        &ArgsCodec<Args>::encode};
+        }
+        manager.connect<EventTag>(this, [](const auto&...) {});
+    }
+
+    // ---- EventLoopInterface ---- //
+    void post(size_t tag, void* data) override {
+        post(EventWrapper(tag, data));
+    }
+
+    void post(const EventWrapper& ev) override {
+        post_batch(&ev, 1);
+    }
+
+    void post_batch(const EventWrapper* evs, size_t count) override {
+        bool was_empty;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            not_full_.wait(lock, [this] { return stop_ || pending_.size() < max_pending_; });
+            was_empty = pending_.empty();
+            for (size_t i = 0; i < count; ++i) encode(evs[i]);
+        }
+        for (size_t i = 0; i < count; ++i) discard_event(evs[i]);
+        if (was_empty) not_empty_.notify_one();
+    }
+
+    void connect(size_t, Callback) override {}
+
+    // Sender loop: ships whatever has been queued, one sendmsg() per batch,
+    // until stop(). Everything queued before stop() is still sent.
+    void run() override {
+        RunScope scope(this);
+        std::vector<char> sending;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                not_empty_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+                if (pending_.empty()) return;
+                sending.swap(pending_);
+            }
+            not_full_.notify_all();
+
+            if (!send_all(sending.data(), sending.size())) {
+                std::unique_lock<std::mutex> lock(mtx_);
+                broken_ = true;
+            }
+            sending.clear();
+        }
+    }
+
+    void stop() {
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    Stats stats() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        return stats_;
+    }
+
+private:
+    struct Codec {
+        uint64_t id;
+        size_t size;
+        EventRecorder::Encoder encode;
+    };
+
+    // With mtx_ held.
+    void encode(const EventWrapper& ev) {
+        auto it = codecs_.find(ev.tag);
+        if (it == codecs_.end() || broken_ || fd_ < 0) {
+            stats_.dropped++;
+            return;
+        }
+        const Codec& codec = it->second;
+
+        size_t at = pending_.size();
+        pending_.resize(at + journal::frame_size(codec.size));
+        journal::FrameHeader header{codec.id, trace::now_ns(), static_cast<uint32_t>(codec.size), 0};
+        std::memcpy(pending_.data() + at, &header, sizeof(header));
+        codec.encode(ev.data, pending_.data() + at + sizeof(header));
+        stats_.events++;
+    }
+
+    bool send_all(const char* data, size_t len) {
+        size_t sent = 0;
+        while (sent < len) {
+            iovec iov{const_cast<char*>(data + sent), len - sent};
+            msghdr msg{};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            ssize_t n = ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+            std::unique_lock<std::mutex> lock(mtx_);
+            stats_.sends++;
+            stats_.bytes += static_cast<uint64_t>(n);
+        }
+        return true;
+    }
+
+    int fd_ = -1;
+    size_t max_pending_;
+
+    std::mutex mtx_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::vector<char> pending_;
+    std::unordered_map<size_t, Codec> codecs_;
+    bool stop_ = false;
+    bool broken_ = false;
+    Stats stats_{};
+};
+
+// ---- Receiving side ---- //
+class RemoteEventServer {
+public:
+    struct Stats {
+        uint64_t received;
+        uint64_t skipped;       // unknown id or size mismatch
+        uint64_t connections;
+        uint64_t rejected;      // connections dropped for an oversized frame
+    };
+
+    static constexpr size_t kReadChunk = 64 * 1024;
+
+    // Listens on `path`, replacing a stale socket file.
+    explicit RemoteEventServer(const std::string& path, CormanManager& manager = Corman)
+        : path_(path), manager_(manager) {
+        wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        sockaddr_un addr;
+        if (!remote::make_address(path, addr)) return;
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+        if (listen_fd_ < 0) return;
+        ::unlink(path.c_str());
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::listen(listen_fd_, 16) != 0) {
+            ::close(listen_fd_);
+            listen_fd_ = -1;
+        }
+    }
+
+    ~RemoteEventServer() {
+        for (auto& conn : conns_) ::close(conn.fd);
+        if (listen_fd_ >= 0) {
+            ::close(listen_fd_);
+            ::unlink(path_.c_str());
+        }
+        if (wake_fd_ >= 0) ::close(wake_fd_);
+    }
+
+    RemoteEventServer(const RemoteEventServer&) = delete;
+    RemoteEventServer& operator=(const RemoteEventServer&) = delete;
+
+    bool is_open() const { return listen_fd_ >= 0 && wake_fd_ >= 0; }
+
+    // Registers an event type; its frames are re-generated through gen().
+    // Call before run().
+    template<typename EventTag>
+    void accept() {
+        using Args = typename EventTraits<EventTag>::Args;
+        static_assert(ArgsCodec<Args>::packable,
+                      "Remote event arguments must be trivially copyable and hold no addresses");
+        static_assert(event_id<EventTag>::value != 0, "Remote events must be defined with OSKA_DEFINE_EVENT");
+
+        CormanManager* manager = &manager_;
+        decoders_[event_id<EventTag>::value] = [manager](const char* payload, uint32_t len) {
+            if (len != ArgsCodec<Args>::size) return false;
+            std::unique_ptr<Args> args(ArgsCodec<Args>::decode(payload));
+            std::apply([manager](auto&... a) { manager->template gen<EventTag>(a...); }, *args);
+            return true;
+        };
+        max_len_ = std::max(max_len_, ArgsCodec<Args>::size);
+    }
+
+    // Serves connections until stop(). Each chunk read from a connection is
+    // dispatched with producer batching on, so a sender's batch reaches the
+    // local loop as one post_batch().
+    void run() {
+        std::vector<pollfd> fds;
+        while (!stop_.load(std::memory_order_acquire)) {
+            fds.clear();
+            fds.push_back({wake_fd_, POLLIN, 0});
+            fds.push_back({listen_fd_, POLLIN, 0});
+            for (auto& conn : conns_) fds.push_back({conn.fd, POLLIN, 0});
+
+            if (::poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            if (fds[1].revents & POLLIN) accept_clients();
+
+            for (size_t i = 2; i < fds.size(); ++i) {
+                Conn& conn = conns_[i - 2];
+                if ((fds[i].revents & (POLLIN | POLLHUP | POLLERR)) && !read_from(conn)) {
+                    ::close(conn.fd);
+                    conn.fd = -1;
+                }
+            }
+            conns_.erase(std::remove_if(conns_.begin(), conns_.end(), [](const Conn& c) { return c.fd < 0; }),
+                         conns_.end());
+        }
+    }
+
+    void stop() {
+        stop_.store(true, std::memory_order_release);
+        uint64_t one = 1;
+        if (::write(wake_fd_, &one, sizeof(one)) < 0) {
+            // Counter saturated; the server is awake anyway.
+        }
+    }
+
+    Stats stats() const {
+        return {received_.load(std::memory_order_relaxed), skipped_.load(std::memory_order_relaxed),
+                connections_.load(std::memory_order_relaxed), rejected_.load(std::memory_order_relaxed)};
+    }
+
+private:
+    struct Conn {
+        int fd;
+        std::vector<char> buffer;   // a partial frame left from the last read
+    };
+
+    void accept_clients() {
+        for (;;) {
+            int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) return;
+            conns_.push_back(Conn{fd, {}});
+            connections_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // False once the peer has gone, or sent a frame longer than any accepted
+    // event's, which would otherwise grow the buffer without bound.
+    bool read_from(Conn& conn) {
+        size_t have = conn.buffer.size();
+        conn.buffer.resize(have + kReadChunk);
+        ssize_t n = ::read(conn.fd, conn.buffer.data() + have, kReadChunk);
+        if (n <= 0) {
+            conn.buffer.resize(have);
+            return n < 0 && errno == EINTR;
+        }
+        conn.buffer.resize(have + static_cast<size_t>(n));
+
+        size_t at = 0;
+        {
+            CormanManager::BatchScope batch;
+            while (conn.buffer.size() - at >= sizeof(journal::FrameHeader)) {
+                journal::FrameHeader header;
+                std::memcpy(&header, conn.buffer.data() + at, sizeof(header));
+                if (header.len > max_len_) {
+                    rejected_.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                size_t size = journal::frame_size(header.len);
+                if (conn.buffer.size() - at < size) break;
+
+                auto it = decoders_.find(header.id);
+                if (it != decoders_.end() && it->second(conn.buffer.data() + at + sizeof(header), header.len)) {
+                    received_.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    skipped_.fetch_add(1, std::memory_order_relaxed);
+                }
+                at += size;
+            }
+        }
+        conn.buffer.erase(conn.buffer.begin(), conn.buffer.begin() + static_cast<long>(at));
+        return true;
+    }
+
+    std::string path_;
+    CormanManager& manager_;
+    int listen_fd_ = -1;
+    int wake_fd_ = -1;
+    std::atomic<bool> stop_{false};
+
+    std::vector<Conn> conns_;
+    std::unordered_map<uint64_t, std::function<bool(const char*, uint32_t)>> decoders_;
+    size_t max_len_ = 0;                    // largest ArgsCodec size accepted
+
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> skipped_{0};
+    std::atomic<uint64_t> connections_{0};
+    std::atomic<uint64_t> rejected_{0};
+};
+
+} // namespace oska
+
+#endif // OSKA_REMOTE_HPP
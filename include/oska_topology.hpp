@@ -0,0 +1,352 @@
+#ifndef OSKA_TOPOLOGY_HPP
+#define OSKA_TOPOLOGY_HPP
+
+// CPU topology, thread pinning and NUMA-local storage.
+//
+// Topology::detect() reads sysfs once and describes the CPUs this process may
+// run on. A Placement names a CPU and/or a NUMA node; loops take one as a
+// construction option, pin the thread that calls run() to it and keep their
+// queue storage on its node:
+//
+//     auto topo = topo::Topology::detect();
+//     auto where = topo.layout(4);               // one loop per physical core
+//     EpollEventLoop loop("io-0", Corman, where[0]);
+//     std::thread t([&] { loop.run(); });        // run() pins itself
+//
+// Without libnuma, memory placement uses mbind()/set_mempolicy() directly with
+// MPOL_PREFERRED, so it degrades to ordinary allocation on machines or
+// kernels without NUMA support.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace oska {
+
+// Where a loop runs and keeps its storage. -1 leaves that part to the OS.
+struct Placement {
+    int cpu = -1;
+    int node = -1;
+
+    bool any() const { return cpu >= 0 || node >= 0; }
+};
+
+namespace topo {
+
+struct Cpu {
+    int id;
+    int core;       // core_id, unique only within a package
+    int package;
+    int node;
+};
+
+// Parses the sysfs list format, e.g. "0-3,8,10-11".
+inline std::vector<int> parse_cpulist(const std::string& text) {
+    std::vector<int> ids;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos) end = text.size();
+        std::string item = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t dash = item.find('-');
+        try {
+            int lo = std::stoi(item.substr(0, dash));
+            int hi = dash == std::string::npos ? lo : std::stoi(item.substr(dash + 1));
+            for (int i = lo; i <= hi; ++i) ids.push_back(i);
+        } catch (...) {
+            // Blank or malformed entry (e.g. trailing newline); skip it.
+        }
+    }
+    return ids;
+}
+
+namespace detail {
+
+inline bool read_line(const std::string& path, std::string& out) {
+    std::ifstream in(path);
+    return static_cast<bool>(std::getline(in, out));
+}
+
+inline int read_int(const std::string& path, int fallback) {
+    std::string line;
+    if (!read_line(path, line)) return fallback;
+    try {
+        return std::stoi(line);
+    } catch (...) {
+        return fallback;
+    }
+}
+
+inline void bind_pages(void* addr, size_t len, int node) {
+    if (node < 0 || node >= static_cast<int>(8 * sizeof(unsigned long))) return;
+    unsigned long mask = 1UL << node;
+    // Best effort: ENOSYS/EINVAL just leave the default policy in place.
+    ::syscall(SYS_mbind, addr, len, MPOL_PREFERRED, &mask, 8 * sizeof(mask), 0);
+}
+
+inline size_t page_round(size_t bytes) {
+    static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return (bytes + page - 1) / page * page;
+}
+
+} // namespace detail
+
+class Topology {
+public:
+    // CPUs this process is allowed to run on, by id.
+    static Topology detect() {
+        Topology t;
+
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        bool have_mask = ::sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+        std::string online;
+        std::vector<int> ids;
+        if (detail::read_line("/sys/devices/system/cpu/online", online)) {
+            ids = parse_cpulist(online);
+        }
+        if (ids.empty()) {
+            unsigned n = std::thread::hardware_concurrency();
+            for (unsigned i = 0; i < (n ? n : 1); ++i) ids.push_back(static_cast<int>(i));
+        }
+
+        for (int id : ids) {
+            if (have_mask && id < CPU_SETSIZE && !CPU_ISSET(id, &allowed)) continue;
+            std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/topology/";
+            t.cpus_.push_back(Cpu{id,
+                                  detail::read_int(base + "core_id", id),
+                                  detail::read_int(base + "physical_package_id", 0),
+                                  0});
+        }
+
+        if (DIR* dir = ::opendir("/sys/devices/system/node")) {
+            while (dirent* entry = ::readdir(dir)) {
+                std::string name = entry->d_name;
+                if (name.compare(0, 4, "node") != 0 || name.size() == 4) continue;
+                int node;
+                try {
+                    node = std::stoi(name.substr(4));
+                } catch (...) {
+                    continue;
+                }
+                std::string list;
+                if (!detail::read_line("/sys/devices/system/node/" + name + "/cpulist", list)) continue;
+                for (int id : parse_cpulist(list)) {
+                    for (auto& cpu : t.cpus_) {
+                        if (cpu.id == id) cpu.node = node;
+                    }
+                }
+            }
+            ::closedir(dir);
+        }
+        return t;
+    }
+
+    const std::vector<Cpu>& cpus() const { return cpus_; }
+
+    // Node of `cpu`, or -1 if it is not one of ours.
+    int node_of(int cpu) const {
+        for (const auto& c : cpus_) {
+            if (c.id == cpu) return c.node;
+        }
+        return -1;
+    }
+
+    std::vector<int> nodes() const {
+        std::vector<int> out;
+        for (const auto& c : cpus_) {
+            if (std::find(out.begin(), out.end(), c.node) == out.end()) out.push_back(c.node);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    // The lowest-numbered CPU of every physical core (hyperthread siblings
+    // dropped), grouped by node so neighbouring entries share a socket.
+    std::vector<Cpu> one_per_core() const {
+        std::vector<Cpu> sorted = cpus_;
+        std::sort(sorted.begin(), sorted.end(), [](const Cpu& a, const Cpu& b) {
+            if (a.node != b.node) return a.node < b.node;
+            if (a.package != b.package) return a.package < b.package;
+            if (a.core != b.core) return a.core < b.core;
+            return a.id < b.id;
+        });
+
+        std::vector<Cpu> out;
+        for (const auto& c : sorted) {
+            if (out.empty() || out.back().package != c.package || out.back().core != c.core) {
+                out.push_back(c);
+            }
+        }
+        return out;
+    }
+
+    // Placements for `loops` loops, one per physical core. Wraps around if
+    // there are more loops than cores.
+    std::vector<Placement> layout(size_t loops) const {
+        std::vector<Cpu> cores = one_per_core();
+        std::vector<Placement> out;
+        if (cores.empty()) {
+            out.resize(loops);
+            return out;
+        }
+        for (size_t i = 0; i < loops; ++i) {
+            const Cpu& c = cores[i % cores.size()];
+            out.push_back(Placement{c.id, c.node});
+        }
+        return out;
+    }
+
+private:
+    std::vector<Cpu> cpus_;
+};
+
+// ---- Threads ---- //
+inline bool pin_thread(pthread_t thread, int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+}
+
+inline bool pin_current_thread(int cpu) {
+    return pin_thread(::pthread_self(), cpu);
+}
+
+// Prefers `node` for the calling thread's future page faults.
+inline bool prefer_node(int node) {
+    if (node < 0 || node >= static_cast<int>(8 * sizeof(unsigned long))) return false;
+    unsigned long mask = 1UL << node;
+    return ::syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, 8 * sizeof(mask)) == 0;
+}
+
+// The node a placement's storage should live on.
+inline int node_for(const Placement& where) {
+    if (where.node >= 0 || where.cpu < 0) return where.node;
+    return Topology::detect().node_of(where.cpu);
+}
+
+// Pins the calling thread and prefers its memory node. A placement with only
+// a cpu uses that CPU's node. Returns false if pinning was asked for and
+// failed.
+inline bool apply(const Placement& where) {
+    if (!where.any()) return true;
+    int node = node_for(where);
+    if (node >= 0) prefer_node(node);
+    return where.cpu < 0 || pin_current_thread(where.cpu);
+}
+
+// std::thread that is placed before `fn` runs.
+template <typename Fn, typename... Args>
+std::thread spawn(const Placement& where, Fn&& fn, Args&&... args) {
+    return std::thread([where](auto&& f, auto&&... a) {
+        apply(where);
+        std::invoke(std::forward<decltype(f)>(f), std::forward<decltype(a)>(a)...);
+    }, std::forward<Fn>(fn), std::forward<Args>(args)...);
+}
+
+// ---- Memory ---- //
+// Allocator whose blocks prefer one NUMA node. Node -1 is plain operator new.
+// Every block of a placed allocator is its own page-rounded mmap() plus
+// mbind(), so use it for storage sized once up front (a fixed ring, or a
+// vector reserve()d at construction), not for containers that keep growing
+// or for many small nodes.
+template <typename T>
+class NodeAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    NodeAllocator() = default;
+    explicit NodeAllocator(int node) : node_(node) {}
+
+    template <typename U>
+    NodeAllocator(const NodeAllocator<U>& other) : node_(other.node()) {}
+
+    int node() const { return node_; }
+
+    T* allocate(size_t n) {
+        size_t bytes = n * sizeof(T);
+        if (node_ < 0) return static_cast<T*>(::operator new(bytes));
+
+        size_t len = detail::page_round(bytes);
+        void* p = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) throw std::bad_alloc();
+        detail::bind_pages(p, len, node_);
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t n) {
+        if (node_ < 0) {
+            ::operator delete(p);
+            return;
+        }
+        ::munmap(p, detail::page_round(n * sizeof(T)));
+    }
+
+    template <typename U>
+    bool operator==(const NodeAllocator<U>& other) const { return node_ == other.node(); }
+
+    template <typename U>
+    bool operator!=(const NodeAllocator<U>& other) const { return node_ != other.node(); }
+
+private:
+    int node_ = -1;
+};
+
+template <typename T>
+struct NodeDelete {
+    int node = -1;
+
+    void operator()(T* p) const {
+        if (!p) return;
+        p->~T();
+        NodeAllocator<T>(node).deallocate(p, 1);
+    }
+};
+
+template <typename T>
+using NodePtr = std::unique_ptr<T, NodeDelete<T>>;
+
+// Constructs a T (e.g. a Channel, whose ring is stored inline) in memory on
+// `node`.
+template <typename T, typename... Args>
+NodePtr<T> make_on_node(int node, Args&&... args) {
+    NodeAllocator<T> alloc(node);
+    T* p = alloc.allocate(1);
+    try {
+        new (p) T(std::forward<Args>(args)...);
+    } catch (...) {
+        alloc.deallocate(p, 1);
+        throw;
+    }
+    return NodePtr<T>(p, NodeDelete<T>{node});
+}
+
+} // namespace topo
+
+} // namespace oska
+
+#endif // OSKA_TOPOLOGY_HPP
@@ -0,0 +1,407 @@
+#ifndef OSKA_TRACE_HPP
+#define OSKA_TRACE_HPP
+
+// Event latency tracing.
+//
+// Build with OSKA_TRACING defined to compile tracing in. Without it every
+// type below except Histogram collapses to an empty inline no-op and
+// EventWrapper carries no timestamps, so the hot path is unchanged.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace oska {
+namespace trace {
+
+inline uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---- Histogram ---- //
+// Log-linear buckets in the style of HdrHistogram: 16 linear sub-buckets per
+// power of two, so every recorded value is kept within ~6% precision.
+// Recording is a handful of relaxed atomic increments.
+class Histogram {
+public:
+    static constexpr unsigned kSubBits = 4;
+    static constexpr unsigned kSubCount = 1u << kSubBits;
+    static constexpr size_t kBuckets = (64 - kSubBits + 1) * kSubCount;
+
+    void record(uint64_t value) {
+        counts_[index_of(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t seen = max_.load(std::memory_order_relaxed);
+        while (value > seen && !max_.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+    uint64_t mean() const {
+        uint64_t n = count();
+        return n ? sum_.load(std::memory_order_relaxed) / n : 0;
+    }
+
+    // Upper bound of the bucket holding the given percentile (0..100).
+    uint64_t percentile(double p) const {
+        uint64_t total = count();
+        if (total == 0) return 0;
+
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total) + 0.5);
+        if (rank == 0) rank = 1;
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += counts_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                uint64_t upper = upper_bound_of(i);
+                return upper < max() ? upper : max();
+            }
+        }
+        return max();
+    }
+
+    // Adds the counts of `other`, e.g. to combine per-thread histograms.
+    void merge(const Histogram& other) {
+        for (size_t i = 0; i < kBuckets; ++i) {
+            uint64_t n = other.counts_[i].load(std::memory_order_relaxed);
+            if (n) counts_[i].fetch_add(n, std::memory_order_relaxed);
+        }
+        count_.fetch_add(other.count(), std::memory_order_relaxed);
+        sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        uint64_t value = other.max();
+        uint64_t seen = max_.load(std::memory_order_relaxed);
+        while (value > seen && !max_.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Moves every sample into `out` and leaves this histogram empty. Unlike
+    // merge() followed by reset(), a sample recorded concurrently is never
+    // lost; it lands in this drain or the next one.
+    void drain_into(Histogram& out) {
+        for (size_t i = 0; i < kBuckets; ++i) {
+            uint64_t n = counts_[i].exchange(0, std::memory_order_relaxed);
+            if (n) out.counts_[i].fetch_add(n, std::memory_order_relaxed);
+        }
+        out.count_.fetch_add(count_.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        out.sum_.fetch_add(sum_.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+
+        uint64_t value = max_.exchange(0, std::memory_order_relaxed);
+        uint64_t seen = out.max_.load(std::memory_order_relaxed);
+        while (value > seen && !out.max_.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    void reset() {
+        for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    static size_t index_of(uint64_t value) {
+        if (value < kSubCount) return static_cast<size_t>(value);
+        unsigned msb = 63u - static_cast<unsigned>(__builtin_clzll(value));
+        unsigned shift = msb - kSubBits;
+        return (msb - kSubBits + 1) * kSubCount + ((value >> shift) & (kSubCount - 1));
+    }
+
+    static uint64_t upper_bound_of(size_t index) {
+        if (index < kSubCount) return index;
+        unsigned magnitude = static_cast<unsigned>(index / kSubCount) - 1;
+        uint64_t sub = index % kSubCount;
+        uint64_t base = (kSubCount + sub) << magnitude;
+        return base + ((uint64_t(1) << magnitude) - 1);
+    }
+
+private:
+    std::atomic<uint64_t> counts_[kBuckets] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+#ifdef OSKA_TRACING
+
+// ---- Per-event statistics ---- //
+struct EventStats {
+    Histogram dispatch;   // gen() until the target loop's post()
+    Histogram queue;      // post() until the handler starts
+    Histogram handler;    // handler execution time
+    std::atomic<uint64_t> slow{0};
+};
+
+// ---- Registry ---- //
+class LoopTracer;
+
+class Registry {
+public:
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    void name_event(size_t tag, const char* name) {
+        std::unique_lock<std::mutex> lock(mtx);
+        names[tag] = name;
+    }
+
+    std::string event_name(size_t tag) {
+        std::unique_lock<std::mutex> lock(mtx);
+        auto it = names.find(tag);
+        if (it != names.end()) return it->second;
+        std::ostringstream os;
+        os << "tag:" << std::hex << tag;
+        return os.str();
+    }
+
+    void add(LoopTracer* tracer) {
+        std::unique_lock<std::mutex> lock(mtx);
+        tracers.push_back(tracer);
+    }
+
+    void remove(LoopTracer* tracer) {
+        std::unique_lock<std::mutex> lock(mtx);
+        for (auto it = tracers.begin(); it != tracers.end(); ++it) {
+            if (*it == tracer) {
+                tracers.erase(it);
+                break;
+            }
+        }
+    }
+
+    inline void dump(std::ostream& os, bool reset = false);
+
+private:
+    std::unordered_map<size_t, std::string> names;
+    std::vector<LoopTracer*> tracers;
+    std::mutex mtx;
+};
+
+// ---- LoopTracer ---- //
+// One per event loop. Per-tag statistics live in a fixed open-addressing
+// table that is filled with CAS, so the recording path never takes a lock.
+class LoopTracer {
+public:
+    using SlowHandler = std::function<void(const std::string& loop, size_t tag, uint64_t ns)>;
+
+    static constexpr size_t kSlots = 256;
+
+    explicit LoopTracer(std::string name = "loop") : name_(std::move(name)) {
+        Registry::instance().add(this);
+    }
+
+    ~LoopTracer() {
+        Registry::instance().remove(this);
+        for (auto& s : stats_) delete s.load(std::memory_order_relaxed);
+    }
+
+    LoopTracer(const LoopTracer&) = delete;
+    LoopTracer& operator=(const LoopTracer&) = delete;
+
+    const std::string& name() const { return name_; }
+
+    // Must be configured before the loop starts running.
+    void set_slow_handler(std::chrono::nanoseconds threshold, SlowHandler cb = nullptr) {
+        slow_cb_ = std::move(cb);
+        slow_ns_.store(static_cast<uint64_t>(threshold.count()), std::memory_order_relaxed);
+    }
+
+    // Returns nullptr if the tag was never recorded.
+    EventStats* stats(size_t tag) { return lookup(tag, false); }
+
+    EventStats& total() { return total_; }
+
+    void record(size_t tag, uint64_t gen_ns, uint64_t post_ns, uint64_t start_ns, uint64_t end_ns) {
+        EventStats* s = lookup(tag, true);
+        uint64_t handler_ns = end_ns - start_ns;
+
+        for (EventStats* target : {s, &total_}) {
+            if (!target) continue;
+            if (gen_ns && post_ns >= gen_ns) target->dispatch.record(post_ns - gen_ns);
+            if (post_ns && start_ns >= post_ns) target->queue.record(start_ns - post_ns);
+            target->handler.record(handler_ns);
+        }
+
+        uint64_t slow = slow_ns_.load(std::memory_order_relaxed);
+        if (slow && handler_ns >= slow) {
+            if (s) s->slow.fetch_add(1, std::memory_order_relaxed);
+            total_.slow.fetch_add(1, std::memory_order_relaxed);
+            if (slow_cb_) slow_cb_(name_, tag, handler_ns);
+        }
+    }
+
+    template <typename F>
+    void for_each(F&& f) {
+        for (size_t i = 0; i < kSlots; ++i) {
+            EventStats* s = stats_[i].load(std::memory_order_acquire);
+            if (s) f(keys_[i].load(std::memory_order_relaxed), *s);
+        }
+    }
+
+private:
+    EventStats* lookup(size_t tag, bool create) {
+        size_t i = (tag >> 4) % kSlots;
+        for (size_t probe = 0; probe < kSlots; ++probe, i = (i + 1) % kSlots) {
+            size_t key = keys_[i].load(std::memory_order_acquire);
+            if (key == 0) {
+                if (!create) return nullptr;
+                if (!keys_[i].compare_exchange_strong(key, tag, std::memory_order_acq_rel)) {
+                    if (key != tag) continue;
+                } else {
+                    stats_[i].store(new EventStats(), std::memory_order_release);
+                    return stats_[i].load(std::memory_order_relaxed);
+                }
+            } else if (key != tag) {
+                continue;
+            }
+
+            // Slot claimed by another thread; wait for its stats to appear.
+            EventStats* s;
+            while ((s = stats_[i].load(std::memory_order_acquire)) == nullptr) {
+                std::this_thread::yield();
+            }
+            return s;
+        }
+        return nullptr; // table full, only the loop totals are kept
+    }
+
+    std::string name_;
+    std::atomic<size_t> keys_[kSlots] = {};
+    std::atomic<EventStats*> stats_[kSlots] = {};
+    EventStats total_;
+    std::atomic<uint64_t> slow_ns_{0};
+    SlowHandler slow_cb_;
+};
+
+inline void Registry::dump(std::ostream& os, bool reset) {
+    auto line = [&os](const char* what, const Histogram& h) {
+        os << ' ' << what << "_p50=" << h.percentile(50)
+           << ' ' << what << "_p99=" << h.percentile(99)
+           << ' ' << what << "_max=" << h.max();
+    };
+
+    std::unique_lock<std::mutex> lock(mtx);
+    for (LoopTracer* tracer : tracers) {
+        tracer->for_each([&](size_t tag, EventStats& s) {
+            auto it = names.find(tag);
+            os << "loop=" << tracer->name() << " event=";
+            if (it != names.end()) os << it->second;
+            else os << "tag:" << std::hex << tag << std::dec;
+            os << " count=" << s.handler.count();
+            line("dispatch_ns", s.dispatch);
+            line("queue_ns", s.queue);
+            line("handler_ns", s.handler);
+            os << " slow=" << s.slow.load(std::memory_order_relaxed) << '\n';
+
+            if (reset) {
+                s.dispatch.reset();
+                s.queue.reset();
+                s.handler.reset();
+                s.slow.store(0, std::memory_order_relaxed);
+            }
+        });
+    }
+}
+
+// ---- HandlerScope ---- //
+// Wraps one handler invocation inside a loop's run():
+//
+//     oska::trace::HandlerScope scope(tracer, ev);
+//     it->second(ev.data);
+template <typename Wrapper>
+class HandlerScope {
+public:
+    HandlerScope(LoopTracer& tracer, const Wrapper& ev)
+        : tracer_(tracer), tag_(ev.tag), gen_ns_(ev.gen_ns), post_ns_(ev.post_ns), start_ns_(now_ns()) {}
+
+    ~HandlerScope() {
+        tracer_.record(tag_, gen_ns_, post_ns_, start_ns_, now_ns());
+    }
+
+private:
+    LoopTracer& tracer_;
+    size_t tag_;
+    uint64_t gen_ns_;
+    uint64_t post_ns_;
+    uint64_t start_ns_;
+};
+
+#else // OSKA_TRACING
+
+class LoopTracer {
+public:
+    using SlowHandler = std::function<void(const std::string&, size_t, uint64_t)>;
+    explicit LoopTracer(std::string = "loop") {}
+    void set_slow_handler(std::chrono::nanoseconds, SlowHandler = nullptr) {}
+};
+
+class Registry {
+public:
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+    void name_event(size_t, const char*) {}
+    void dump(std::ostream&, bool = false) {}
+};
+
+template <typename Wrapper>
+class HandlerScope {
+public:
+    HandlerScope(LoopTracer&, const Wrapper&) {}
+};
+
+#endif // OSKA_TRACING
+
+// ---- PeriodicDump ---- //
+// Writes Registry::dump() to a sink at a fixed interval until destroyed.
+class PeriodicDump {
+public:
+    using Sink = std::function<void(const std::string&)>;
+
+    PeriodicDump(std::chrono::milliseconds interval, Sink sink, bool reset = true)
+        : worker_([this, interval, sink = std::move(sink), reset] {
+            std::unique_lock<std::mutex> lock(mtx_);
+            while (!cv_.wait_for(lock, interval, [this] { return stop_; })) {
+                std::ostringstream os;
+                Registry::instance().dump(os, reset);
+                sink(os.str());
+            }
+        }) {}
+
+    ~PeriodicDump() {
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        worker_.join();
+    }
+
+private:
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread worker_;
+};
+
+} // namespace trace
+} // namespace oska
+
+#endif // OSKA_TRACE_HPP
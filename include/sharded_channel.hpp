@@ -0,0 +1,284 @@
+#ifndef SHARDED_CHANNEL_H
+#define SHARDED_CHANNEL_H
+
+// MPMC channel split into `Shards` lock-free sub-rings of N slots each.
+//
+// Every thread has a home shard (assigned round robin on first use, or set
+// with set_home(), e.g. to its CPU). Producers fill their home shard and only
+// spill into the others when it is full; consumers drain their home shard
+// first and then steal. Ordering is FIFO per shard only, so items from one
+// producer thread stay in order as long as its home shard never fills up.
+//
+// The fast path touches no shared lock; the mutex and condition variables of
+// ChannelBase are only used to park threads when every shard is empty (or
+// full). add/get/try_add/try_get/close behave like Channel<Type, N>: once
+// closed no more items are accepted, and consumers drain what is left before
+// seeing CLOSED.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "channel.hpp"
+
+namespace oska
+{
+
+template <typename Type, size_t N, size_t Shards = 8>
+class ShardedChannel : public ChannelBase {
+    static_assert(N > 0, "ShardedChannel has no unbuffered form");
+    static_assert(Shards > 0, "ShardedChannel needs at least one shard");
+
+public:
+    ShardedChannel() {
+        for (auto& shard : shards_) {
+            for (size_t i = 0; i < N; ++i) shard.slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~ShardedChannel() {
+        for (auto& shard : shards_) {
+            while (Type* item = pop(shard)) delete item;
+        }
+    }
+
+    ShardedChannel(const ShardedChannel&) = delete;
+    ShardedChannel& operator=(const ShardedChannel&) = delete;
+
+    // Sets the calling thread's home shard (taken modulo Shards).
+    static void set_home(size_t shard) { home_ = shard % Shards; }
+    static size_t home() { return home_ % Shards; }
+
+    template <typename U>
+    Result add(U&& var) {
+        return adder(std::forward<U>(var), true);
+    }
+
+    // FULL only when every shard is full.
+    template <typename U>
+    Result try_add(U&& var) {
+        return adder(std::forward<U>(var), false);
+    }
+
+    Result add_ptr(std::unique_ptr<Type>&& item) {
+        if (!item) return Result::EMPTY;
+        return storer([&item] { return item.release(); }, true);
+    }
+
+    Result try_add_ptr(std::unique_ptr<Type>&& item) {
+        if (!item) return Result::EMPTY;
+        return storer([&item] { return item.release(); }, false);
+    }
+
+    std::unique_ptr<Type> get(Result& result = dummy_result_) {
+        return getter(result, true);
+    }
+
+    std::unique_ptr<Type> try_get(Result& result = dummy_result_) {
+        return getter(result, false);
+    }
+
+    void close() {
+        closing_.store(true, std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(sync_mutex_);
+            closed_ = true;
+        }
+        consumer_cv_.notify_all();
+        producer_cv_.notify_all();
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq;
+        Type* item = nullptr;
+    };
+
+    // Bounded MPMC ring with per-slot sequence numbers (Vyukov); the two
+    // cursors sit on their own cache lines.
+    struct alignas(64) Shard {
+        alignas(64) std::atomic<size_t> enqueue_pos{0};
+        std::atomic<size_t> inflight{0};    // producers homed here mid-add
+        alignas(64) std::atomic<size_t> dequeue_pos{0};
+        alignas(64) Slot slots[N];
+    };
+
+    template <typename Make>
+    static bool push(Shard& shard, Make& make) {
+        size_t pos = shard.enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = shard.slots[pos % N];
+            size_t seq = slot.seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (shard.enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.item = make();
+                    slot.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // full
+            } else {
+                pos = shard.enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static Type* pop(Shard& shard) {
+        size_t pos = shard.dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = shard.slots[pos % N];
+            size_t seq = slot.seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (shard.dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    Type* item = slot.item;
+                    slot.seq.store(pos + N, std::memory_order_release);
+                    return item;
+                }
+            } else if (diff < 0) {
+                return nullptr;   // empty
+            } else {
+                pos = shard.dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Home shard first, then the others in order.
+    template <typename Make>
+    bool push_any(Make& make) {
+        size_t start = home();
+        for (size_t i = 0; i < Shards; ++i) {
+            if (push(shards_[(start + i) % Shards], make)) return true;
+        }
+        return false;
+    }
+
+    Type* pop_any() {
+        size_t start = home();
+        for (size_t i = 0; i < Shards; ++i) {
+            if (Type* item = pop(shards_[(start + i) % Shards])) return item;
+        }
+        return nullptr;
+    }
+
+    // Closed for consumers: no more items can show up.
+    bool drained() const {
+        if (!closing_.load(std::memory_order_seq_cst)) return false;
+        for (const auto& shard : shards_) {
+            if (shard.inflight.load(std::memory_order_seq_cst) != 0) return false;
+        }
+        return true;
+    }
+
+    void wake(std::atomic<size_t>& waiting, std::condition_variable& cv) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) != 0) {
+            { std::unique_lock<std::mutex> lock(sync_mutex_); }
+            cv.notify_all();
+        }
+    }
+
+    template <typename U>
+    Result adder(U&& var, bool block) {
+        auto make = [&var] {
+            if constexpr (std::is_move_constructible_v<Type>) {
+                return new Type(std::forward<U>(var));
+            } else if constexpr (std::is_copy_constructible_v<Type>) {
+                return new Type(var);
+            } else {
+                static_assert(dependent_false_v<Type>, "Type is neither move nor copy constructible");
+                return static_cast<Type*>(nullptr);
+            }
+        };
+        return storer(make, block);
+    }
+
+    // `make` runs once a slot is claimed, so nothing is moved from on failure.
+    template <typename Make>
+    Result storer(Make make, bool block) {
+        // Counted before looking at closing_, so consumers cannot report
+        // CLOSED while this item is on its way in. Kept per shard so the
+        // counter does not become the shared hot spot.
+        std::atomic<size_t>& inflight = shards_[home()].inflight;
+        inflight.fetch_add(1, std::memory_order_seq_cst);
+        Result result = Result::CLOSED;
+        for (;;) {
+            if (closing_.load(std::memory_order_seq_cst)) break;
+            if (push_any(make)) {
+                result = Result::OK;
+                break;
+            }
+            if (!block) {
+                result = Result::FULL;
+                break;
+            }
+
+            std::unique_lock<std::mutex> lock(sync_mutex_);
+            producers_waiting_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool pushed = !closing_.load(std::memory_order_seq_cst) && push_any(make);
+            if (!pushed && !closing_.load(std::memory_order_seq_cst)) producer_cv_.wait(lock);
+            producers_waiting_.fetch_sub(1, std::memory_order_relaxed);
+            if (pushed) {
+                result = Result::OK;
+                break;
+            }
+        }
+        inflight.fetch_sub(1, std::memory_order_seq_cst);
+        wake(consumers_waiting_, consumer_cv_);
+        return result;
+    }
+
+    std::unique_ptr<Type> getter(Result& result, bool block) {
+        for (;;) {
+            if (Type* item = pop_any()) {
+                wake(producers_waiting_, producer_cv_);
+                result = Result::OK;
+                return std::unique_ptr<Type>(item);
+            }
+            if (drained()) {
+                // Anything pushed before the last producer left is visible now.
+                if (Type* item = pop_any()) {
+                    result = Result::OK;
+                    return std::unique_ptr<Type>(item);
+                }
+                result = Result::CLOSED;
+                return nullptr;
+            }
+            if (!block) {
+                result = Result::EMPTY;
+                return nullptr;
+            }
+
+            std::unique_lock<std::mutex> lock(sync_mutex_);
+            consumers_waiting_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            Type* item = pop_any();
+            if (!item && !drained()) consumer_cv_.wait(lock);
+            consumers_waiting_.fetch_sub(1, std::memory_order_relaxed);
+            if (item) {
+                lock.unlock();
+                wake(producers_waiting_, producer_cv_);
+                result = Result::OK;
+                return std::unique_ptr<Type>(item);
+            }
+        }
+    }
+
+    Shard shards_[Shards];
+
+    alignas(64) std::atomic<bool> closing_{false};
+    std::atomic<size_t> producers_waiting_{0};
+    std::atomic<size_t> consumers_waiting_{0};
+
+    inline static std::atomic<size_t> next_home_{0};
+    inline static thread_local size_t home_ = next_home_.fetch_add(1, std::memory_order_relaxed);
+};
+
+} // namespace oska
+
+#endif // SHARDED_CHANNEL_H
@@ -0,0 +1,392 @@
+#ifndef SHM_CHANNEL_H
+#define SHM_CHANNEL_H
+
+// Inter-process Channel for trivially copyable types.
+//
+// The ring, its lock and its wait words live in one shared mapping: either a
+// named POSIX shared memory object (create/open by name) or an anonymous
+// MAP_SHARED region inherited across fork(). Blocking uses process-shared
+// futexes on words inside the mapping, so no kernel copy is involved in a
+// transfer.
+//
+// Every attached process registers its pid, up to shm::kMaxPeers of them. If
+// one of them dies without detaching -- including while it holds the ring
+// lock -- the next waiter notices, and the channel is closed with
+// peer_died() set.
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "channel.hpp"
+
+namespace oska
+{
+
+namespace shm {
+
+inline long futex_wait(std::atomic<uint32_t>* addr, uint32_t expected, long timeout_ns) {
+    struct timespec ts;
+    ts.tv_sec = timeout_ns / 1000000000L;
+    ts.tv_nsec = timeout_ns % 1000000000L;
+    return ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, expected, &ts, nullptr, 0);
+}
+
+inline void futex_wake(std::atomic<uint32_t>* addr, int count) {
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, count, nullptr, nullptr, 0);
+}
+
+// A zombie (exited but not yet reaped) counts as dead.
+inline bool pid_alive(uint32_t pid) {
+    if (pid == 0) return true;
+    if (::kill(static_cast<pid_t>(pid), 0) != 0) return errno != ESRCH;
+
+    char path[32];
+    std::snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+    FILE* f = std::fopen(path, "r");
+    if (!f) return true;
+    char state = 0;
+    int matched = std::fscanf(f, "%*d (%*[^)]) %c", &state);
+    std::fclose(f);
+    return matched != 1 || state != 'Z';
+}
+
+// How long a waiter sleeps before checking that its peers are still alive.
+constexpr long kPeerCheckNs = 50 * 1000 * 1000;
+
+constexpr uint32_t kMagic = 0x4f534b41; // "OSKA"
+constexpr size_t kMaxPeers = 16;
+
+} // namespace shm
+
+template <typename Type, size_t N>
+class ShmChannel {
+    static_assert(std::is_trivially_copyable_v<Type>, "ShmChannel requires a trivially copyable Type");
+    static_assert(N > 0, "ShmChannel has no unbuffered form");
+
+public:
+    using Result = ChannelBase::Result;
+
+    // Anonymous shared mapping; share it with children by fork()ing after
+    // construction.
+    ShmChannel() {
+        void* map = ::mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (map != MAP_FAILED) {
+            shared_ = new (map) Shared();
+            shared_->magic.store(shm::kMagic, std::memory_order_release);
+            if (!attach()) {
+                ::munmap(map, sizeof(Shared));
+                shared_ = nullptr;
+            }
+        }
+    }
+
+    static std::unique_ptr<ShmChannel> create(const std::string& name) {
+        return std::unique_ptr<ShmChannel>(new ShmChannel(name, true));
+    }
+
+    static std::unique_ptr<ShmChannel> open(const std::string& name) {
+        return std::unique_ptr<ShmChannel>(new ShmChannel(name, false));
+    }
+
+    // Removes the name; attached processes keep their mapping.
+    static void unlink(const std::string& name) {
+        ::shm_unlink(name.c_str());
+    }
+
+    ~ShmChannel() {
+        if (!shared_) return;
+        detach();
+        ::munmap(shared_, sizeof(Shared));
+    }
+
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+
+    bool is_open() const { return shared_ != nullptr; }
+
+    // Call in a fork()ed child before using an inherited channel, so the
+    // child is tracked as a peer too. Returns false if all shm::kMaxPeers
+    // slots are taken; the others would then not notice this process dying.
+    bool attach() {
+        if (!shared_) return false;
+        pid_ = static_cast<uint32_t>(::getpid());
+        registered_ = false;
+        for (auto& peer : shared_->peers) {
+            if (peer.load(std::memory_order_acquire) == pid_) {
+                registered_ = true;
+                return true;
+            }
+        }
+        for (auto& peer : shared_->peers) {
+            uint32_t expected = 0;
+            if (peer.compare_exchange_strong(expected, pid_)) {
+                registered_ = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool peer_died() const {
+        return shared_ && shared_->peer_died.load(std::memory_order_acquire) != 0;
+    }
+
+    template <typename U>
+    Result add(U&& var) {
+        return adder(var, true);
+    }
+
+    template <typename U>
+    Result try_add(U&& var) {
+        return adder(var, false);
+    }
+
+    std::unique_ptr<Type> get(Result& result = dummy_result_) {
+        auto item = std::make_unique<Type>();
+        result = getter(*item, true);
+        if (result != Result::OK) item.reset();
+        return item;
+    }
+
+    std::unique_ptr<Type> try_get(Result& result = dummy_result_) {
+        auto item = std::make_unique<Type>();
+        result = getter(*item, false);
+        if (result != Result::OK) item.reset();
+        return item;
+    }
+
+    // Allocation-free form of get(): copies the item straight out of the ring.
+    Result get(Type& out) {
+        return getter(out, true);
+    }
+
+    Result try_get(Type& out) {
+        return getter(out, false);
+    }
+
+    // Same semantics as Channel::close: queued items can still be drained.
+    void close() {
+        if (!shared_) return;
+        lock();
+        shared_->closing = 1;
+        unlock();
+        wake_all();
+    }
+
+private:
+    struct Shared {
+        std::atomic<uint32_t> magic{0};
+        std::atomic<uint32_t> lock{0};          // owner pid, 0 when free
+        std::atomic<uint32_t> lock_waiters{0};
+        std::atomic<uint32_t> not_empty{0};     // futex sequence words
+        std::atomic<uint32_t> not_full{0};
+        std::atomic<uint32_t> consumers_waiting{0};
+        std::atomic<uint32_t> producers_waiting{0};
+        std::atomic<uint32_t> peer_died{0};
+        std::atomic<uint32_t> peers[shm::kMaxPeers] = {};
+        uint32_t closing = 0;
+        uint64_t head = 0;
+        uint64_t tail = 0;
+        Type slots[N];
+    };
+
+    ShmChannel(const std::string& name, bool create) {
+        int fd = create ? ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600)
+                        : ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) return;
+
+        bool ok = true;
+        if (create) {
+            ok = ::ftruncate(fd, sizeof(Shared)) == 0;
+        } else {
+            struct stat st;
+            ok = ::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == sizeof(Shared);
+        }
+
+        void* map = ok ? ::mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            if (create) ::shm_unlink(name.c_str());
+            return;
+        }
+
+        shared_ = static_cast<Shared*>(map);
+        if (create) {
+            new (map) Shared();
+            shared_->magic.store(shm::kMagic, std::memory_order_release);
+        } else if (shared_->magic.load(std::memory_order_acquire) != shm::kMagic) {
+            ::munmap(map, sizeof(Shared));
+            shared_ = nullptr;
+            return;
+        }
+        if (!attach()) {
+            ::munmap(map, sizeof(Shared));
+            shared_ = nullptr;
+            if (create) ::shm_unlink(name.c_str());
+        }
+    }
+
+    // Only the process that registered removes the registration; a fork()ed
+    // child that never called attach() leaves its parent's in place.
+    void detach() {
+        if (!registered_ || pid_ != static_cast<uint32_t>(::getpid())) return;
+        for (auto& peer : shared_->peers) {
+            uint32_t expected = pid_;
+            if (peer.compare_exchange_strong(expected, 0)) {
+                return;
+            }
+        }
+    }
+
+    bool is_full() const { return shared_->head - shared_->tail == N; }
+    bool is_empty() const { return shared_->head == shared_->tail; }
+
+    // Checks registered peers; a dead one closes the channel for good.
+    bool check_peers() {
+        for (auto& peer : shared_->peers) {
+            uint32_t pid = peer.load(std::memory_order_acquire);
+            if (pid != 0 && pid != pid_ && !shm::pid_alive(pid)) {
+                peer.compare_exchange_strong(pid, 0);
+                shared_->peer_died.store(1, std::memory_order_release);
+            }
+        }
+        return !peer_died();
+    }
+
+    void lock() {
+        auto& word = shared_->lock;
+        for (int spin = 0;; ++spin) {
+            uint32_t owner = 0;
+            if (word.compare_exchange_weak(owner, pid_, std::memory_order_acquire)) {
+                return;
+            }
+            if (spin < 64 || owner == 0) continue;
+
+            shared_->lock_waiters.fetch_add(1, std::memory_order_relaxed);
+            long rc = shm::futex_wait(&word, owner, shm::kPeerCheckNs);
+            shared_->lock_waiters.fetch_sub(1, std::memory_order_relaxed);
+
+            if (rc != 0 && errno == ETIMEDOUT && !shm::pid_alive(owner)) {
+                // The owner died inside the critical section; take over and
+                // refuse further traffic since the ring may be inconsistent.
+                if (word.compare_exchange_strong(owner, pid_, std::memory_order_acquire)) {
+                    shared_->peer_died.store(1, std::memory_order_release);
+                    return;
+                }
+            }
+        }
+    }
+
+    void unlock() {
+        shared_->lock.store(0, std::memory_order_release);
+        if (shared_->lock_waiters.load(std::memory_order_relaxed) != 0) {
+            shm::futex_wake(&shared_->lock, 1);
+        }
+    }
+
+    void wake_all() {
+        shared_->not_empty.fetch_add(1, std::memory_order_release);
+        shared_->not_full.fetch_add(1, std::memory_order_release);
+        shm::futex_wake(&shared_->not_empty, INT_MAX);
+        shm::futex_wake(&shared_->not_full, INT_MAX);
+    }
+
+    // Releases the lock and sleeps until `word` moves or a peer check is due.
+    // Returns with the lock held again, false if a peer died meanwhile.
+    bool wait_on(std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiting) {
+        uint32_t seq = word.load(std::memory_order_acquire);
+        waiting.fetch_add(1, std::memory_order_relaxed);
+        unlock();
+
+        long rc = shm::futex_wait(&word, seq, shm::kPeerCheckNs);
+        bool timed_out = rc != 0 && errno == ETIMEDOUT;
+
+        waiting.fetch_sub(1, std::memory_order_relaxed);
+        lock();
+        return !(timed_out && !check_peers()) && !peer_died();
+    }
+
+    void signal(std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiting) {
+        word.fetch_add(1, std::memory_order_release);
+        if (waiting.load(std::memory_order_relaxed) != 0) {
+            shm::futex_wake(&word, 1);
+        }
+    }
+
+    Result adder(const Type& var, bool block) {
+        if (!shared_) return Result::CLOSED;
+        lock();
+
+        while (!shared_->closing && !peer_died() && is_full()) {
+            if (!block) {
+                unlock();
+                return Result::FULL;
+            }
+            if (!wait_on(shared_->not_full, shared_->producers_waiting)) break;
+        }
+
+        if (shared_->closing || peer_died()) {
+            unlock();
+            wake_all();
+            return Result::CLOSED;
+        }
+
+        std::memcpy(&shared_->slots[shared_->head % N], &var, sizeof(Type));
+        shared_->head++;
+        signal(shared_->not_empty, shared_->consumers_waiting);
+        unlock();
+        return Result::OK;
+    }
+
+    Result getter(Type& out, bool block) {
+        if (!shared_) return Result::CLOSED;
+        lock();
+
+        while (!peer_died() && is_empty() && !shared_->closing) {
+            if (!block) {
+                unlock();
+                return Result::EMPTY;
+            }
+            if (!wait_on(shared_->not_empty, shared_->consumers_waiting)) break;
+        }
+
+        if (peer_died() || is_empty()) {
+            unlock();
+            wake_all();
+            return Result::CLOSED;
+        }
+
+        std::memcpy(&out, &shared_->slots[shared_->tail % N], sizeof(Type));
+        shared_->tail++;
+        signal(shared_->not_full, shared_->producers_waiting);
+        unlock();
+        return Result::OK;
+    }
+
+    Shared* shared_ = nullptr;
+    uint32_t pid_ = 0;              // set by attach(); owns the ring lock
+    bool registered_ = false;       // pid_ holds a slot in shared_->peers
+
+    inline static Result dummy_result_;
+};
+
+} // namespace oska
+
+#endif // SHM_CHANNEL_H
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "oska_actor.hpp"
+
+using namespace oska;
+
+OSKA_DEFINE_EVENT(EvAdd, int)
+OSKA_DEFINE_EVENT(EvSeq, int, int)
+OSKA_DEFINE_EVENT(EvPing, int)
+OSKA_DEFINE_EVENT(EvHold, std::shared_ptr<int>)
+OSKA_DEFINE_EVENT(EvGate, int)
+
+struct Counter : Actor {
+    long sum = 0;
+};
+
+TEST(ActorTest, IdleActorIsSmall) {
+    static_assert(sizeof(Actor) <= 32, "idle actor should stay in the tens of bytes");
+    static_assert(sizeof(Counter) <= 40, "actor state adds only its own fields");
+}
+
+TEST(ActorTest, ManyActorsEachGetTheirMessages) {
+    ActorSystem actors(ActorSystem::Options{4, 16});
+    actors.connect<EvAdd, Counter>([](Counter& self, int n) { self.sum += n; });
+
+    std::vector<Counter> counters(100000);
+    for (int round = 1; round <= 3; ++round) {
+        for (auto& c : counters) EXPECT_TRUE(actors.gen<EvAdd>(c, round));
+    }
+    actors.wait_idle();
+
+    for (const auto& c : counters) ASSERT_EQ(c.sum, 6);
+}
+
+struct Sequencer : Actor {
+    std::vector<int> last = std::vector<int>(4, -1);
+    std::atomic<int> inside{0};
+    bool overlapped = false;
+    bool out_of_order = false;
+};
+
+TEST(ActorTest, OneActorHandlesSequentiallyInSenderOrder) {
+    ActorSystem actors(ActorSystem::Options{4, 8});
+    actors.connect<EvSeq, Sequencer>([](Sequencer& self, int sender, int i) {
+        if (self.inside.fetch_add(1) != 0) self.overlapped = true;
+        if (self.last[sender] + 1 != i) self.out_of_order = true;
+        self.last[sender] = i;
+        self.inside.fetch_sub(1);
+    });
+
+    Sequencer target;
+    constexpr int kMessages = 20000;
+    std::vector<std::thread> senders;
+    for (int s = 0; s < 4; ++s) {
+        senders.emplace_back([&, s] {
+            for (int i = 0; i < kMessages; ++i) actors.gen<EvSeq>(target, s, i);
+        });
+    }
+    for (auto& t : senders) t.join();
+    actors.wait_idle();
+
+    EXPECT_FALSE(target.overlapped);
+    EXPECT_FALSE(target.out_of_order);
+    for (int s = 0; s < 4; ++s) EXPECT_EQ(target.last[s], kMessages - 1);
+}
+
+struct Recorder : Actor {
+    int id = 0;
+    std::vector<int>* order = nullptr;
+};
+
+TEST(ActorTest, QuantumLetsOtherActorsRun) {
+    constexpr size_t kQuantum = 8;
+    ActorSystem actors(ActorSystem::Options{1, kQuantum});
+
+    std::promise<void> release;
+    std::shared_future<void> gate = release.get_future().share();
+    actors.connect<EvGate, Counter>([gate](Counter&, int) { gate.wait(); });
+
+    std::vector<int> order;
+    actors.connect<EvAdd, Recorder>([](Recorder& self, int) { self.order->push_back(self.id); });
+
+    // The only worker is held by `blocker` while both mailboxes fill.
+    Counter blocker;
+    Recorder busy, quiet;
+    busy.id = 1;
+    busy.order = &order;
+    quiet.id = 2;
+    quiet.order = &order;
+
+    actors.gen<EvGate>(blocker, 0);
+    for (int i = 0; i < 100; ++i) actors.gen<EvAdd>(busy, i);
+    actors.gen<EvAdd>(quiet, 0);
+    release.set_value();
+    actors.wait_idle();
+
+    ASSERT_EQ(order.size(), 101u);
+    for (size_t i = 0; i < kQuantum; ++i) EXPECT_EQ(order[i], 1);
+    EXPECT_EQ(order[kQuantum], 2);
+}
+
+struct Player : Actor {
+    Player* peer = nullptr;
+    int hits = 0;
+};
+
+TEST(ActorTest, HandlersSendToOtherActors) {
+    ActorSystem actors(ActorSystem::Options{2, 4});
+    actors.connect<EvPing, Player>([&actors](Player& self, int left) {
+        self.hits++;
+        if (left > 0) actors.gen<EvPing>(*self.peer, left - 1);
+    });
+
+    Player a, b;
+    a.peer = &b;
+    b.peer = &a;
+    actors.gen<EvPing>(a, 999);
+    actors.wait_idle();
+
+    EXPECT_EQ(a.hits, 500);
+    EXPECT_EQ(b.hits, 500);
+}
+
+TEST(ActorTest, UnboundEventIsDropped) {
+    ActorSystem actors(ActorSystem::Options{1, 4});
+    actors.connect<EvAdd, Counter>([](Counter& self, int n) { self.sum += n; });
+
+    Player player;
+    EXPECT_FALSE(actors.gen<EvAdd>(player, 1));   // bound for Counter only
+    EXPECT_EQ(actors.dropped(), 1u);
+
+    Counter counter;
+    EXPECT_TRUE(actors.gen<EvAdd>(counter, 1));
+    actors.wait_idle();
+    EXPECT_EQ(counter.sum, 1);
+}
+
+TEST(ActorTest, DestroyedActorFreesUnhandledMessages) {
+    auto payload = std::make_shared<int>(7);
+    {
+        ActorSystem actors(ActorSystem::Options{1, 4});
+        actors.connect<EvHold, Counter>([](Counter& self, std::shared_ptr<int> p) { self.sum += *p; });
+        actors.stop();
+
+        Counter counter;
+        for (int i = 0; i < 3; ++i) EXPECT_TRUE(actors.gen<EvHold>(counter, payload));
+        EXPECT_EQ(payload.use_count(), 4);
+        EXPECT_EQ(counter.sum, 0);
+    }
+    EXPECT_EQ(payload.use_count(), 1);
+}
+
+TEST(ActorTest, SendAfterStopDoesNotScheduleTheActor) {
+    ActorSystem actors(ActorSystem::Options{2, 4});
+    actors.connect<EvAdd, Counter>([](Counter& self, int n) { self.sum += n; });
+
+    Counter before;
+    actors.gen<EvAdd>(before, 1);
+    actors.stop();
+    EXPECT_EQ(before.sum, 1);          // runnable actors finish first
+
+    {
+        Counter after;
+        EXPECT_TRUE(actors.gen<EvAdd>(after, 2));
+        EXPECT_TRUE(actors.gen<EvAdd>(after, 3));
+        actors.wait_idle();            // nothing will run it, so nothing is active
+        EXPECT_EQ(after.sum, 0);
+    }                                  // freed with the actor, not left on the run queue
+    actors.wait_idle();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+#include "oska_epoll_loop.hpp"
+#include "oska_priority_loop.hpp"
+#include "oska_balancer.hpp"
+
+using namespace oska;
+
+OSKA_DEFINE_EVENT(EvMigrate, int)
+OSKA_DEFINE_EVENT(EvHotTag, int)
+OSKA_DEFINE_EVENT(EvWarmTag, int)
+
+// Runs handlers inline from post(); has no task support.
+class InlineLoop : public EventLoopInterface {
+public:
+    void post(size_t tag, void* data) override {
+        auto it = callbacks.find(tag);
+        if (it != callbacks.end()) it->second(data);
+    }
+    void connect(size_t tag, Callback cb) override { callbacks[tag] = cb; }
+    void run() override {}
+
+    std::unordered_map<size_t, Callback> callbacks;
+};
+
+static void spin_for(std::chrono::microseconds d) {
+    auto end = std::chrono::steady_clock::now() + d;
+    while (std::chrono::steady_clock::now() < end) {
+    }
+}
+
+TEST(MigrationTest, KeepsPerTagOrderUnderLoad) {
+    CormanManager manager;
+    EpollEventLoop a("migrate-a", manager);
+    PriorityEventLoop b("migrate-b");
+
+    std::vector<int> seen;
+    std::vector<EventLoopInterface*> ran_on;
+    std::atomic<int> handled{0};
+    manager.connect<EvMigrate>(&a, [&](int v) {
+        seen.push_back(v);
+        ran_on.push_back(EventLoopInterface::current());
+        handled++;
+    });
+
+    std::thread ra([&] { a.run(); });
+    std::thread rb([&] { b.run(); });
+
+    constexpr int kEvents = 200000;
+    std::thread producer([&] {
+        for (int i = 0; i < kEvents; ++i) manager.gen<EvMigrate>(i);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    auto there = manager.migrate<EvMigrate>(&b);
+    EXPECT_EQ(there.get(), std::optional<bool>(true));
+    auto back = manager.migrate<EvMigrate>(&a);
+    EXPECT_EQ(back.get(), std::optional<bool>(true));
+    auto again = manager.migrate<EvMigrate>(&b);
+    EXPECT_EQ(again.get(), std::optional<bool>(true));
+    producer.join();
+    manager.gen<EvMigrate>(kEvents);   // after the last move, so handled on b
+
+    while (handled != kEvents + 1) std::this_thread::yield();
+    a.stop();
+    b.stop();
+    ra.join();
+    rb.join();
+
+    ASSERT_EQ(seen.size(), static_cast<size_t>(kEvents + 1));
+    for (int i = 0; i <= kEvents; ++i) ASSERT_EQ(seen[i], i);
+    EXPECT_EQ(ran_on.back(), &b);
+}
+
+TEST(MigrationTest, RefusesWhatCannotMove) {
+    CormanManager manager;
+    EpollEventLoop a("refuse-a", manager);
+    EpollEventLoop b("refuse-b", manager);
+    InlineLoop plain;
+
+    EXPECT_EQ(manager.migrate<EvMigrate>(&b).get(), std::optional<bool>(false));   // not bound
+
+    manager.connect<EvMigrate>(&a, [](int) {});
+    EXPECT_EQ(manager.migrate<EvMigrate>(&a).get(), std::optional<bool>(false));   // same loop
+    EXPECT_EQ(manager.migrate<EvMigrate>(&plain).get(), std::optional<bool>(false));
+
+    manager.connect<EvMigrate>(&plain, [](int) {});
+    EXPECT_EQ(manager.migrate<EvMigrate>(&b).get(), std::optional<bool>(false));
+}
+
+TEST(MigrationTest, ReconnectDuringMoveWins) {
+    CormanManager manager;
+    EpollEventLoop a("rebind-a", manager);
+    EpollEventLoop b("rebind-b", manager);
+    EpollEventLoop c("rebind-c", manager);
+
+    std::atomic<int> on_old{0};
+    std::vector<int> seen;
+    std::atomic<int> on_new{0};
+    manager.connect<EvMigrate>(&a, [&](int) { on_old++; });
+
+    // `a` is not running yet, so the move stays open and gen() holds events.
+    auto moved = manager.migrate<EvMigrate>(&b);
+    manager.gen<EvMigrate>(0);
+    manager.gen<EvMigrate>(1);
+    manager.connect<EvMigrate>(&c, [&](int v) {
+        EXPECT_EQ(EventLoopInterface::current(), &c);
+        seen.push_back(v);
+        on_new++;
+    });
+    manager.gen<EvMigrate>(2);
+
+    std::thread ra([&] { a.run(); });
+    std::thread rb([&] { b.run(); });
+    std::thread rc([&] { c.run(); });
+    EXPECT_EQ(moved.get(), std::optional<bool>(false));
+    manager.gen<EvMigrate>(3);
+
+    while (on_new != 4) std::this_thread::yield();
+    a.stop();
+    b.stop();
+    c.stop();
+    ra.join();
+    rb.join();
+    rc.join();
+
+    EXPECT_EQ(on_old.load(), 0);
+    EXPECT_EQ(seen, (std::vector<int>{0, 1, 2, 3}));
+}
+
+TEST(MigrationTest, LoadsReportHandlerTime) {
+    CormanManager manager;
+    EpollEventLoop loop("loads", manager);
+    manager.set_load_tracking(true);
+    std::atomic<int> handled{0};
+    manager.connect<EvHotTag>(&loop, [&](int) {
+        spin_for(std::chrono::microseconds(100));
+        handled++;
+    });
+
+    std::thread runner([&] { loop.run(); });
+    for (int i = 0; i < 20; ++i) manager.gen<EvHotTag>(i);
+    while (handled != 20) std::this_thread::yield();
+    loop.stop();
+    runner.join();
+
+    auto loads = manager.loads();
+    ASSERT_EQ(loads.size(), 1u);
+    EXPECT_EQ(loads[0].tag, TypeId<EvHotTag>::value());
+    EXPECT_EQ(loads[0].target, &loop);
+    EXPECT_EQ(loads[0].handled, 20u);
+    EXPECT_GE(loads[0].busy_ns, 20u * 100000u);
+}
+
+TEST(LoadBalancerTest, MovesATagOffTheBusyLoop) {
+    CormanManager manager;
+    EpollEventLoop busy("balance-busy", manager);
+    EpollEventLoop idle("balance-idle", manager);
+
+    std::atomic<int> handled{0};
+    manager.connect<EvHotTag>(&busy, [&](int) {
+        spin_for(std::chrono::microseconds(50));
+        handled++;
+    });
+    manager.connect<EvWarmTag>(&busy, [&](int) {
+        spin_for(std::chrono::microseconds(20));
+        handled++;
+    });
+
+    LoadBalancer::Options options;
+    options.min_busy_ns = 1000;
+    LoadBalancer balancer(manager, {&busy, &idle}, options);
+
+    std::thread rb([&] { busy.run(); });
+    std::thread ri([&] { idle.run(); });
+
+    for (int i = 0; i < 100; ++i) {
+        manager.gen<EvHotTag>(i);
+        manager.gen<EvWarmTag>(i);
+    }
+    while (handled != 200) std::this_thread::yield();
+
+    EXPECT_TRUE(balancer.rebalance());
+    EXPECT_EQ(balancer.migrations(), 1u);
+
+    auto moved = [&] {
+        for (const auto& load : manager.loads()) {
+            if (load.target == &idle) return true;
+        }
+        return false;
+    };
+    while (!moved()) std::this_thread::yield();
+
+    // One tag per loop now; the last tag on a loop is never moved.
+    EXPECT_FALSE(balancer.rebalance());
+
+    balancer.stop();
+    busy.stop();
+    idle.stop();
+    rb.join();
+    ri.join();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "byte_channel.hpp"
+
+using namespace oska;
+using Result = ChannelBase::Result;
+
+static void write_str(ByteChannel& ring, const std::string& s) {
+    auto out = ring.reserve(s.size());
+    ASSERT_TRUE(out);
+    std::memcpy(out.data, s.data(), s.size());
+    ring.commit(s.size());
+}
+
+TEST(ByteChannelTest, RoundsCapacityToPages) {
+    ByteChannel ring(100);
+    ASSERT_TRUE(ring.is_open());
+    EXPECT_EQ(ring.capacity() % static_cast<size_t>(::sysconf(_SC_PAGESIZE)), 0u);
+    EXPECT_GE(ring.capacity(), 100u);
+}
+
+TEST(ByteChannelTest, ReserveCommitPeekConsume) {
+    ByteChannel ring(4096);
+    write_str(ring, "hello ");
+    write_str(ring, "world");
+
+    Result result;
+    auto in = ring.peek(1, result);
+    ASSERT_EQ(result, Result::OK);
+    EXPECT_EQ(std::string(in.data, in.size), "hello world");
+
+    ring.consume(6);
+    in = ring.peek();
+    EXPECT_EQ(std::string(in.data, in.size), "world");
+    ring.consume(in.size);
+    EXPECT_EQ(ring.readable(), 0u);
+
+    ring.try_peek(1, result);
+    EXPECT_EQ(result, Result::EMPTY);
+}
+
+TEST(ByteChannelTest, SpansStayContiguousAcrossTheWrap) {
+    ByteChannel ring(4096);
+    size_t cap = ring.capacity();
+
+    // Move the cursors close to the end of the ring.
+    ring.reserve(cap - 10);
+    ring.commit(cap - 10);
+    ring.consume(ring.peek().size);
+
+    std::string msg(100, 'x');
+    for (size_t i = 0; i < msg.size(); ++i) msg[i] = static_cast<char>('a' + i % 26);
+    write_str(ring, msg);
+
+    auto in = ring.peek(msg.size());
+    ASSERT_EQ(in.size, msg.size());
+    EXPECT_EQ(std::string(in.data, in.size), msg);
+}
+
+TEST(ByteChannelTest, FullAndOversizedReservations) {
+    ByteChannel ring(4096);
+    size_t cap = ring.capacity();
+    Result result;
+
+    ring.reserve(cap + 1, result);
+    EXPECT_EQ(result, Result::FULL);
+
+    ring.reserve(cap, result);
+    ASSERT_EQ(result, Result::OK);
+    ring.commit(cap);
+    EXPECT_FALSE(ring.try_reserve(1, result));
+    EXPECT_EQ(result, Result::FULL);
+
+    ring.consume(1);
+    EXPECT_TRUE(ring.try_reserve(1, result));
+}
+
+TEST(ByteChannelTest, CloseLeavesCommittedBytesReadable) {
+    ByteChannel ring(4096);
+    write_str(ring, "abc");
+    ring.close();
+
+    Result result;
+    ring.reserve(1, result);
+    EXPECT_EQ(result, Result::CLOSED);
+
+    auto in = ring.peek(10, result);   // fewer than asked for, but final
+    ASSERT_EQ(result, Result::OK);
+    EXPECT_EQ(std::string(in.data, in.size), "abc");
+    ring.consume(in.size);
+
+    ring.peek(1, result);
+    EXPECT_EQ(result, Result::CLOSED);
+}
+
+TEST(ByteChannelTest, StreamsFramedMessagesBetweenThreads) {
+    ByteChannel ring(8192);
+    constexpr uint32_t kMessages = 20000;
+
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < kMessages; ++i) {
+            uint32_t len = 1 + i % 700;
+            auto out = ring.reserve(sizeof(len) + len);
+            std::memcpy(out.data, &len, sizeof(len));
+            std::memset(out.data + sizeof(len), static_cast<int>(i & 0xff), len);
+            ring.commit(sizeof(len) + len);
+        }
+        ring.close();
+    });
+
+    uint32_t received = 0;
+    bool ok = true;
+    for (;;) {
+        Result result;
+        auto in = ring.peek(sizeof(uint32_t), result);
+        if (result != Result::OK) break;
+        uint32_t len;
+        std::memcpy(&len, in.data, sizeof(len));
+        in = ring.peek(sizeof(len) + len, result);
+        ASSERT_EQ(result, Result::OK);
+        for (uint32_t j = 0; j < len; ++j) {
+            ok &= static_cast<unsigned char>(in.data[sizeof(len) + j]) == (received & 0xff);
+        }
+        ring.consume(sizeof(len) + len);
+        received++;
+    }
+    producer.join();
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(received, kMessages);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <memory>
+#include "oska_epoll_loop.hpp"
+
+using namespace oska;
+
+OSKA_DEFINE_QUERY_EVENT(QrySquare, long, int)
+OSKA_DEFINE_QUERY_EVENT(QryName, std::string, int)
+OSKA_DEFINE_QUERY_EVENT(QryUnbound, int, int)
+OSKA_DEFINE_EVENT(EvCallFromHandler, int)
+
+class CallTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        runner = std::thread([this] { loop.run(); });
+    }
+
+    void TearDown() override {
+        loop.stop();
+        runner.join();
+    }
+
+    EpollEventLoop loop{"call"};
+    std::thread runner;
+};
+
+TEST_F(CallTest, ReturnsHandlerResult) {
+    Corman.connect<QrySquare>(&loop, [](int x) { return static_cast<long>(x) * x; });
+    Corman.connect<QryName>(&loop, [](int id) { return "id-" + std::to_string(id); });
+
+    auto square = Corman.call<QrySquare>(12);
+    auto name = Corman.call<QryName>(7);
+
+    EXPECT_EQ(square.get(), 144L);
+    EXPECT_EQ(name.get(), std::string("id-7"));
+    EXPECT_FALSE(square.valid());
+}
+
+TEST_F(CallTest, UnboundQueryIsBrokenImmediately) {
+    auto reply = Corman.call<QryUnbound>(1);
+    EXPECT_TRUE(reply.ready());
+    EXPECT_FALSE(reply.get().has_value());
+}
+
+TEST_F(CallTest, GenOnQueryEventDiscardsReply) {
+    std::atomic<int> seen{0};
+    Corman.connect<QrySquare>(&loop, [&](int x) { seen += x; return 0L; });
+
+    Corman.gen<QrySquare>(5);
+    auto sync = Corman.call<QrySquare>(1);
+    sync.wait();
+    EXPECT_EQ(seen.load(), 6);
+}
+
+TEST_F(CallTest, SameLoopCallRunsInline) {
+    Corman.connect<QrySquare>(&loop, [](int x) { return static_cast<long>(x) * x; });
+
+    std::atomic<long> result{0};
+    std::atomic<bool> was_ready{false};
+    Corman.connect<EvCallFromHandler>(&loop, [&](int x) {
+        auto reply = Corman.call<QrySquare>(x);
+        was_ready = reply.ready();
+        result = *reply.get();
+    });
+
+    Corman.gen<EvCallFromHandler>(9);
+    while (result == 0) std::this_thread::yield();
+    EXPECT_TRUE(was_ready.load());
+    EXPECT_EQ(result.load(), 81);
+}
+
+TEST_F(CallTest, SharedStateIsPooled) {
+    Corman.connect<QrySquare>(&loop, [](int x) { return static_cast<long>(x); });
+
+    auto& pool = detail::FutureSlotPool<long>::instance();
+    for (int i = 0; i < 10; ++i) Corman.call<QrySquare>(i).get();
+    size_t allocated = pool.allocated();
+    size_t reused = pool.reused();
+
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(Corman.call<QrySquare>(i).get(), static_cast<long>(i));
+    }
+    // The loop thread may not have released the previous slot by the time
+    // the next call() takes one, so the pool can grow by a slot or two.
+    size_t grown = pool.allocated() - allocated;
+    EXPECT_LE(grown, 2u);
+    EXPECT_EQ(pool.reused() - reused + grown, 1000u);
+}
+
+TEST_F(CallTest, SameLoopCallSurvivesReconnect) {
+    auto bind = [this](long offset) {
+        auto base = std::make_shared<long>(offset);    // freed once the handler is replaced
+        Corman.connect<QrySquare>(&loop, [base](int x) { return *base + x; });
+    };
+    bind(0);
+
+    std::atomic<int> wrong{0};
+    std::atomic<bool> done{false};
+    Corman.connect<EvCallFromHandler>(&loop, [&](int n) {
+        for (int i = 0; i < n; ++i) {
+            auto reply = Corman.call<QrySquare>(1).get();    // handled inline on this loop
+            if (!reply || (*reply != 1 && *reply != 2)) wrong++;
+        }
+        done = true;
+    });
+
+    Corman.gen<EvCallFromHandler>(20000);
+    for (long i = 1; !done.load(); ++i) bind(i % 2);
+    EXPECT_EQ(wrong.load(), 0);
+}
+
+TEST_F(CallTest, WaitForTimesOutWhileHandlerIsBusy) {
+    std::atomic<bool> release{false};
+    Corman.connect<QrySquare>(&loop, [&](int x) {
+        while (!release) std::this_thread::yield();
+        return static_cast<long>(x);
+    });
+
+    auto reply = Corman.call<QrySquare>(3);
+    EXPECT_FALSE(reply.wait_for(std::chrono::milliseconds(5)));
+    release = true;
+    EXPECT_TRUE(reply.wait_for(std::chrono::seconds(5)));
+    EXPECT_EQ(reply.get(), 3L);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <thread>
 #include <vector>
+#include <string>
 #include <chrono>
 #include <future>
 #include "channel.hpp"
@@ -513,6 +514,237 @@ TEST(ChannelSmartPtr, SharedPtrCopy) {
     EXPECT_EQ(**val, 99);
 }
 
+TEST(ChannelAddPtr, QueuesWithoutCopy) {
+    Channel<std::vector<int>, 2> ch;
+    auto item = std::make_unique<std::vector<int>>(1024, 7);
+    const int* data = item->data();
+
+    EXPECT_EQ(ch.add_ptr(std::move(item)), ChannelBase::Result::OK);
+    EXPECT_FALSE(item);
+
+    auto out = ch.get();
+    ASSERT_TRUE(out);
+    EXPECT_EQ(out->data(), data);
+}
+
+TEST(ChannelAddPtr, FailedAddLeavesItemWithCaller) {
+    Channel<int, 1> ch;
+    EXPECT_EQ(ch.add(1), ChannelBase::Result::OK);
+
+    auto item = std::make_unique<int>(2);
+    EXPECT_EQ(ch.try_add_ptr(std::move(item)), ChannelBase::Result::FULL);
+    ASSERT_TRUE(item);
+
+    ch.close();
+    EXPECT_EQ(ch.add_ptr(std::move(item)), ChannelBase::Result::CLOSED);
+    ASSERT_TRUE(item);
+    EXPECT_EQ(*item, 2);
+
+    std::unique_ptr<int> none;
+    EXPECT_EQ(ch.add_ptr(std::move(none)), ChannelBase::Result::EMPTY);
+}
+
+TEST(RecyclingChannelTest, SteadyStateReusesBuffers) {
+    struct Buffer {
+        char bytes[8192];
+    };
+    constexpr int kMessages = 1000;
+    RecyclingChannel<Buffer, 4> ch;
+
+    std::thread consumer([&ch]() {
+        for (auto buf = ch.get(); buf; buf = ch.get()) {
+            ch.recycle(std::move(buf));
+        }
+    });
+
+    for (int i = 0; i < kMessages; ++i) {
+        auto buf = ch.acquire();
+        buf->bytes[0] = static_cast<char>(i);
+        ASSERT_EQ(ch.add_ptr(std::move(buf)), ChannelBase::Result::OK);
+    }
+    ch.close();
+    consumer.join();
+
+    auto stats = ch.stats();
+    EXPECT_EQ(stats.reused + stats.allocated, static_cast<size_t>(kMessages));
+    EXPECT_EQ(stats.recycled + stats.discarded, static_cast<size_t>(kMessages));
+    // Only the ring plus one object on each side is ever outside the pool.
+    EXPECT_LE(stats.allocated, 4u + 2u);
+    EXPECT_EQ(stats.discarded, 0u);
+    EXPECT_EQ(ch.pooled(), stats.allocated);
+}
+
+TEST(RecyclingChannelTest, FullPoolDiscards) {
+    RecyclingChannel<int, 2, 1> ch;
+    ch.recycle(std::make_unique<int>(1));
+    ch.recycle(std::make_unique<int>(2));
+
+    auto stats = ch.stats();
+    EXPECT_EQ(stats.recycled, 1u);
+    EXPECT_EQ(stats.discarded, 1u);
+
+    auto reused = ch.acquire(5);
+    EXPECT_EQ(*reused, 1);
+    auto fresh = ch.acquire(5);
+    EXPECT_EQ(*fresh, 5);
+    EXPECT_EQ(ch.stats().reused, 1u);
+    EXPECT_EQ(ch.stats().allocated, 1u);
+}
+
+TEST(OverwriteChannelTest, FullRingDropsOldest) {
+    OverwriteChannel<int, 4> channel;
+    for (int i = 0; i < 10; ++i) EXPECT_EQ(channel.add(i), ChannelBase::Result::OK);
+    EXPECT_EQ(channel.overruns(), 6u);
+
+    ChannelBase::Result result;
+    uint64_t seq = 0;
+    auto item = channel.get(result, seq);
+    ASSERT_EQ(result, ChannelBase::Result::OK);
+    EXPECT_EQ(*item, 6);
+    EXPECT_EQ(seq, 6u);   // items 0..5 were missed
+
+    for (int i = 7; i < 10; ++i) {
+        EXPECT_EQ(*channel.try_get(result, seq), i);
+        EXPECT_EQ(seq, static_cast<uint64_t>(i));
+    }
+    EXPECT_EQ(channel.try_get(result), nullptr);
+    EXPECT_EQ(result, ChannelBase::Result::EMPTY);
+}
+
+TEST(OverwriteChannelTest, CloseDrainsThenCloses) {
+    OverwriteChannel<std::string, 2> channel;
+    channel.add(std::string("a"));
+    channel.add(std::string("b"));
+    channel.add(std::string("c"));
+    channel.close();
+    EXPECT_EQ(channel.add(std::string("d")), ChannelBase::Result::CLOSED);
+
+    ChannelBase::Result result;
+    EXPECT_EQ(*channel.get(result), "b");
+    EXPECT_EQ(*channel.get(result), "c");
+    EXPECT_EQ(channel.get(result), nullptr);
+    EXPECT_EQ(result, ChannelBase::Result::CLOSED);
+}
+
+TEST(OverwriteChannelTest, ProducerNeverWaitsOnSlowConsumer) {
+    OverwriteChannel<int, 8> channel;
+    constexpr int kItems = 100000;
+
+    std::thread producer([&] {
+        for (int i = 0; i < kItems; ++i) channel.add(i);
+        channel.close();
+    });
+
+    uint64_t received = 0;
+    uint64_t missed = 0;
+    uint64_t expected = 0;
+    uint64_t seq;
+    ChannelBase::Result result;
+    while (auto item = channel.get(result, seq)) {
+        EXPECT_EQ(static_cast<uint64_t>(*item), seq);
+        missed += seq - expected;
+        expected = seq + 1;
+        received++;
+        if (received % 64 == 0) std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    producer.join();
+
+    EXPECT_EQ(received + missed, static_cast<uint64_t>(kItems));
+    EXPECT_EQ(missed, channel.overruns());
+}
+
+TEST(TimedChannelTest, GetForTimesOutWhenEmpty) {
+    Channel<int, 4> buffered;
+    Channel<int, 0> unbuffered;
+    ChannelBase::Result result;
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(buffered.get_for(std::chrono::milliseconds(10), result));
+    EXPECT_EQ(result, ChannelBase::Result::TIMEOUT);
+    EXPECT_FALSE(unbuffered.get_for(std::chrono::milliseconds(10), result));
+    EXPECT_EQ(result, ChannelBase::Result::TIMEOUT);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+    // The timed-out consumer no longer counts as waiting.
+    EXPECT_EQ(unbuffered.try_add(1), ChannelBase::Result::FULL);
+}
+
+TEST(TimedChannelTest, GetUntilReturnsItemAddedInTime) {
+    Channel<int, 0> channel;
+    std::thread producer([&] { EXPECT_EQ(channel.add(7), ChannelBase::Result::OK); });
+
+    ChannelBase::Result result;
+    auto item = channel.get_until(std::chrono::steady_clock::now() + std::chrono::seconds(5), result);
+    producer.join();
+    ASSERT_TRUE(item);
+    EXPECT_EQ(*item, 7);
+    EXPECT_EQ(result, ChannelBase::Result::OK);
+}
+
+TEST(TimedChannelTest, AddForTimesOutWhenFull) {
+    Channel<int, 2> buffered;
+    Channel<int, 0> unbuffered;
+    EXPECT_EQ(buffered.add(1), ChannelBase::Result::OK);
+    EXPECT_EQ(buffered.add(2), ChannelBase::Result::OK);
+
+    EXPECT_EQ(buffered.add_for(3, std::chrono::milliseconds(5)), ChannelBase::Result::TIMEOUT);
+    EXPECT_EQ(unbuffered.add_until(3, std::chrono::steady_clock::now() + std::chrono::milliseconds(5)),
+              ChannelBase::Result::TIMEOUT);
+    EXPECT_EQ(unbuffered.try_get(), nullptr);
+
+    EXPECT_EQ(*buffered.get(), 1);
+    EXPECT_EQ(*buffered.get(), 2);
+    EXPECT_EQ(buffered.try_get(), nullptr);
+}
+
+TEST(TimedChannelTest, CancelWakesWaitersOnSeveralChannels) {
+    Channel<int, 4> a;
+    Channel<int, 0> b;
+    Channel<int, 1> full;
+    EXPECT_EQ(full.add(0), ChannelBase::Result::OK);
+    CancelToken token;
+
+    ChannelBase::Result got_a = ChannelBase::Result::OK;
+    ChannelBase::Result got_b = ChannelBase::Result::OK;
+    ChannelBase::Result added = ChannelBase::Result::OK;
+    std::thread ta([&] { a.get(token, got_a); });
+    std::thread tb([&] { b.get_for(std::chrono::seconds(30), token, got_b); });
+    std::thread tc([&] { added = full.add(1, token); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    token.cancel();
+    ta.join();
+    tb.join();
+    tc.join();
+
+    EXPECT_EQ(got_a, ChannelBase::Result::CANCELLED);
+    EXPECT_EQ(got_b, ChannelBase::Result::CANCELLED);
+    EXPECT_EQ(added, ChannelBase::Result::CANCELLED);
+
+    // Nothing was closed, and the token can be reused.
+    EXPECT_EQ(a.get(token), nullptr);
+    token.reset();
+    EXPECT_EQ(a.add(5, token), ChannelBase::Result::OK);
+    auto item = a.get(token);
+    ASSERT_TRUE(item);
+    EXPECT_EQ(*item, 5);
+    EXPECT_EQ(*full.get(), 0);
+}
+
+TEST(TimedChannelTest, ReadyItemWinsOverCancellation) {
+    Channel<int, 4> channel;
+    CancelToken token;
+    token.cancel();
+
+    EXPECT_EQ(channel.add(1, token), ChannelBase::Result::OK);
+    ChannelBase::Result result;
+    auto item = channel.get(token, result);
+    ASSERT_TRUE(item);
+    EXPECT_EQ(result, ChannelBase::Result::OK);
+    EXPECT_FALSE(channel.get(token, result));
+    EXPECT_EQ(result, ChannelBase::Result::CANCELLED);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
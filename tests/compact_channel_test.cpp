@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include "compact_channel.hpp"
+
+using namespace oska;
+using Result = ChannelBase::Result;
+
+TEST(CompactChannelTest, IdleChannelIsSmallAndUnallocated) {
+    static_assert(sizeof(CompactChannel<std::string, 1024>) <= 48, "idle channel should stay small");
+    CompactChannel<int, 1024> channel;
+    EXPECT_EQ(channel.allocated(), 0u);
+    EXPECT_EQ(channel.try_get(), nullptr);
+    EXPECT_EQ(channel.allocated(), 0u);
+}
+
+TEST(CompactChannelTest, RingGrowsAndKeepsOrder) {
+    CompactChannel<int, 16> channel;
+    EXPECT_EQ(channel.add(0), Result::OK);
+    EXPECT_EQ(channel.allocated(), 4u);
+
+    for (int i = 1; i < 10; ++i) EXPECT_EQ(channel.add(i), Result::OK);
+    EXPECT_EQ(channel.allocated(), 16u);
+    for (int i = 0; i < 10; ++i) EXPECT_EQ(*channel.get(), i);
+
+    // Wraps around after growing.
+    for (int i = 0; i < 16; ++i) EXPECT_EQ(channel.add(i), Result::OK);
+    EXPECT_EQ(channel.try_add(16), Result::FULL);
+    for (int i = 0; i < 16; ++i) EXPECT_EQ(*channel.get(), i);
+}
+
+TEST(CompactChannelTest, TrimFreesRingAfterIdlePeriod) {
+    CompactChannel<int, 8> channel(std::chrono::milliseconds(100));
+    EXPECT_EQ(channel.add(1), Result::OK);
+    EXPECT_FALSE(channel.trim());                  // not empty
+    EXPECT_EQ(*channel.get(), 1);
+
+    auto now = std::chrono::steady_clock::now();
+    EXPECT_FALSE(channel.trim(now));               // empty, but only just
+    EXPECT_TRUE(channel.trim(now + std::chrono::milliseconds(200)));
+    EXPECT_EQ(channel.allocated(), 0u);
+
+    EXPECT_EQ(channel.add(2), Result::OK);
+    EXPECT_EQ(*channel.get(), 2);
+}
+
+TEST(CompactChannelTest, CloseDrainsThenCloses) {
+    CompactChannel<int, 4> channel;
+    EXPECT_EQ(channel.add(1), Result::OK);
+    channel.close();
+    EXPECT_EQ(channel.add(2), Result::CLOSED);
+
+    Result result;
+    auto item = channel.get(result);
+    ASSERT_TRUE(item);
+    EXPECT_EQ(*item, 1);
+    EXPECT_FALSE(channel.get(result));
+    EXPECT_EQ(result, Result::CLOSED);
+}
+
+TEST(CompactChannelTest, CloseWakesBlockedConsumer) {
+    CompactChannel<int, 4> channel;
+    Result result = Result::OK;
+    std::thread consumer([&] { channel.get(result); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    channel.close();
+    consumer.join();
+    EXPECT_EQ(result, Result::CLOSED);
+}
+
+TEST(CompactChannelTest, ManyChannelsShareTheParkingLot) {
+    constexpr size_t kChannels = 2000;
+    constexpr int kItems = 200;
+    std::vector<std::unique_ptr<CompactChannel<int, 2>>> channels;
+    for (size_t i = 0; i < kChannels; ++i) channels.push_back(std::make_unique<CompactChannel<int, 2>>());
+
+    // Each thread pair works a stripe of channels in the same order; a ring
+    // of two slots makes both sides park often.
+    constexpr size_t kPairs = 4;
+    std::vector<std::thread> threads;
+    std::vector<long> sums(kPairs, 0);
+    for (size_t p = 0; p < kPairs; ++p) {
+        threads.emplace_back([&, p] {
+            for (size_t c = p; c < kChannels; c += kPairs) {
+                for (int i = 0; i < kItems; ++i) channels[c]->add(i);
+                channels[c]->close();
+            }
+        });
+        threads.emplace_back([&, p] {
+            for (size_t c = p; c < kChannels; c += kPairs) {
+                while (auto item = channels[c]->get()) sums[p] += *item;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    long total = 0;
+    for (long s : sums) total += s;
+    EXPECT_EQ(total, static_cast<long>(kChannels) * (kItems - 1) * kItems / 2);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
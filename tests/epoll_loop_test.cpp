@@ -0,0 +1,445 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <unistd.h>
+#include "oska_epoll_loop.hpp"
+
+using namespace oska;
+
+OSKA_DEFINE_EVENT(EvPipeReady, int, uint32_t)
+OSKA_DEFINE_EVENT(EvEpollTick, uint64_t)
+OSKA_DEFINE_EVENT(EvEpollWork, int)
+
+TEST(EpollEventLoopTest, DeliversPostedEventsFromOtherThreads) {
+    EpollEventLoop loop("posted");
+    ASSERT_TRUE(loop.is_open());
+
+    std::atomic<int> sum{0};
+    Corman.connect<EvEpollWork>(&loop, [&](int v) { sum += v; });
+
+    std::thread runner([&] { loop.run(); });
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; ++t) {
+        producers.emplace_back([] {
+            for (int i = 1; i <= 1000; ++i) Corman.gen<EvEpollWork>(i);
+        });
+    }
+    for (auto& p : producers) p.join();
+
+    while (sum.load() != 4 * 500500) std::this_thread::yield();
+    loop.stop();
+    runner.join();
+    EXPECT_EQ(sum.load(), 4 * 500500);
+}
+
+TEST(EpollEventLoopTest, UnboundEventsAreDiscarded) {
+    struct EvUnbound {};
+    EpollEventLoop loop("unbound");
+    auto payload = std::make_shared<int>(1);
+
+    for (int i = 0; i < 2; ++i) {
+        EventWrapper ev(TypeId<EvUnbound>::value(), new std::shared_ptr<int>(payload));
+        ev.discard = [](void* data) { delete static_cast<std::shared_ptr<int>*>(data); };
+        loop.post(ev);
+    }
+    EXPECT_EQ(payload.use_count(), 3);
+
+    loop.stop();
+    loop.run();
+    EXPECT_EQ(payload.use_count(), 1);
+}
+
+TEST(EpollEventLoopTest, QueuedEventsAreDiscardedOnDestruction) {
+    struct EvLeftOver {};
+    auto payload = std::make_shared<int>(1);
+    {
+        EpollEventLoop loop("never-run");
+        EventWrapper ev(TypeId<EvLeftOver>::value(), new std::shared_ptr<int>(payload));
+        ev.discard = [](void* data) { delete static_cast<std::shared_ptr<int>*>(data); };
+        loop.post(ev);
+        EXPECT_EQ(payload.use_count(), 2);
+    }
+    EXPECT_EQ(payload.use_count(), 1);
+}
+
+TEST(EpollEventLoopTest, PipeReadinessBecomesTypedEvent) {
+    EpollEventLoop loop("pipe");
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+
+    std::string received;
+    std::atomic<bool> done{false};
+    Corman.connect<EvPipeReady>(&loop, [&](int fd, uint32_t events) {
+        EXPECT_TRUE(events & EPOLLIN);
+        char buf[64];
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n > 0) received.append(buf, static_cast<size_t>(n));
+        if (received.size() >= 5) done = true;
+    });
+    ASSERT_TRUE(loop.watch<EvPipeReady>(fds[0], EPOLLIN));
+
+    std::thread runner([&] { loop.run(); });
+    ASSERT_EQ(::write(fds[1], "hello", 5), 5);
+
+    while (!done) std::this_thread::yield();
+    loop.stop();
+    runner.join();
+
+    EXPECT_EQ(received, "hello");
+    EXPECT_TRUE(loop.unwatch(fds[0]));
+    EXPECT_FALSE(loop.unwatch(fds[0]));
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(EpollEventLoopTest, TimerFiresPeriodically) {
+    EpollEventLoop loop("timer");
+    std::atomic<uint64_t> ticks{0};
+    Corman.connect<EvEpollTick>(&loop, [&](uint64_t expirations) { ticks += expirations; });
+
+    int tfd = loop.add_timer<EvEpollTick>(std::chrono::milliseconds(2));
+    ASSERT_GE(tfd, 0);
+
+    std::thread runner([&] { loop.run(); });
+    while (ticks < 5) std::this_thread::yield();
+    EXPECT_TRUE(loop.unwatch(tfd));
+    loop.stop();
+    runner.join();
+
+    EXPECT_GE(ticks.load(), 5u);
+}
+
+OSKA_DEFINE_EVENT(EvChainOuter, int)
+OSKA_DEFINE_EVENT(EvChainInner, int)
+OSKA_DEFINE_EVENT(EvChainStep, int)
+
+class LocalDispatchTest : public ::testing::TestWithParam<LocalDispatch> {
+protected:
+    CormanManager manager;
+    EpollEventLoop loop{"local", manager};
+};
+
+TEST_P(LocalDispatchTest, SameLoopChainOrdering) {
+    manager.set_local_dispatch(GetParam());
+
+    std::vector<std::string> order;
+    std::atomic<bool> done{false};
+    manager.connect<EvChainOuter>(&loop, [&](int x) {
+        order.push_back("outer-begin");
+        manager.gen<EvChainInner>(x);
+        order.push_back("outer-end");
+    });
+    manager.connect<EvChainInner>(&loop, [&](int) {
+        order.push_back("inner");
+        done = true;
+    });
+
+    std::thread runner([&] { loop.run(); });
+    manager.gen<EvChainOuter>(1);
+    while (!done) std::this_thread::yield();
+    loop.stop();
+    runner.join();
+
+    if (GetParam() == LocalDispatch::INLINE) {
+        EXPECT_EQ(order, (std::vector<std::string>{"outer-begin", "inner", "outer-end"}));
+    } else {
+        EXPECT_EQ(order, (std::vector<std::string>{"outer-begin", "outer-end", "inner"}));
+    }
+}
+
+TEST_P(LocalDispatchTest, LongChainsStayBounded) {
+    manager.set_local_dispatch(GetParam(), 4);
+
+    int depth = 0;
+    int max_depth = 0;
+    std::atomic<int> last{0};
+    manager.connect<EvChainStep>(&loop, [&](int n) {
+        max_depth = std::max(max_depth, ++depth);
+        if (n < 10000) manager.gen<EvChainStep>(n + 1);
+        --depth;
+        last = n;
+    });
+
+    std::thread runner([&] { loop.run(); });
+    manager.gen<EvChainStep>(0);
+    while (last != 10000) std::this_thread::yield();
+    loop.stop();
+    runner.join();
+
+    EXPECT_LE(max_depth, GetParam() == LocalDispatch::INLINE ? 5 : 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(Modes, LocalDispatchTest,
+    ::testing::Values(LocalDispatch::POST, LocalDispatch::LOCAL_QUEUE, LocalDispatch::INLINE));
+
+TEST(InlineDispatchTest, HandlerSurvivesReconnect) {
+    CormanManager manager;
+    EpollEventLoop loop{"reconnect", manager};
+    manager.set_local_dispatch(LocalDispatch::INLINE);
+
+    std::atomic<int> wrong{0};
+    auto bind = [&](int offset) {
+        auto base = std::make_shared<int>(offset);     // freed once the handler is replaced
+        manager.connect<EvChainInner>(&loop, [base, &wrong](int) {
+            if (*base != 0 && *base != 1) wrong++;
+        });
+    };
+    bind(0);
+
+    std::atomic<bool> done{false};
+    manager.connect<EvChainOuter>(&loop, [&](int n) {
+        for (int i = 0; i < n; ++i) manager.gen<EvChainInner>(i);
+        CormanManager::BatchScope batching;             // cached routes take the same path
+        for (int i = 0; i < n; ++i) manager.gen<EvChainInner>(i);
+        done = true;
+    });
+
+    std::thread runner([&] { loop.run(); });
+    manager.gen<EvChainOuter>(20000);
+    for (int i = 1; !done.load(); ++i) bind(i % 2);
+    loop.stop();
+    runner.join();
+    EXPECT_EQ(wrong.load(), 0);
+}
+
+TEST(InlineDispatchTest, InlineEventsAreLoadTracked) {
+    CormanManager manager;
+    EpollEventLoop loop{"inline-load", manager};
+    manager.set_local_dispatch(LocalDispatch::INLINE);
+    manager.set_load_tracking(true);
+
+    std::atomic<bool> done{false};
+    int inner = 0;
+    manager.connect<EvChainInner>(&loop, [&](int) { inner++; });
+    manager.connect<EvChainOuter>(&loop, [&](int n) {
+        for (int i = 0; i < n; ++i) manager.gen<EvChainInner>(i);
+        EXPECT_EQ(inner, n);        // ran inline, not queued
+        done = true;
+    });
+
+    std::thread runner([&] { loop.run(); });
+    manager.gen<EvChainOuter>(100);
+    while (!done) std::this_thread::yield();
+    loop.stop();
+    runner.join();
+
+    uint64_t handled = 0;
+    for (const auto& load : manager.loads()) {
+        if (load.tag == TypeId<EvChainInner>::value()) handled = load.handled;
+    }
+    EXPECT_EQ(handled, 100u);
+}
+
+OSKA_DEFINE_EVENT(EvBatched, int)
+
+class CountingLoop : public EpollEventLoop {
+public:
+    using EpollEventLoop::EpollEventLoop;
+
+    void post(const EventWrapper& ev) override {
+        posts++;
+        EpollEventLoop::post(ev);
+    }
+
+    void post_batch(const EventWrapper* evs, size_t count) override {
+        batches++;
+        EpollEventLoop::post_batch(evs, count);
+    }
+
+    std::atomic<int> posts{0};
+    std::atomic<int> batches{0};
+};
+
+TEST(ProducerBatchingTest, CombinesEventsPerLoop) {
+    CormanManager manager;
+    CountingLoop a("batch-a", manager);
+    CountingLoop b("batch-b", manager);
+    std::atomic<int> sum_a{0};
+    std::atomic<int> sum_b{0};
+    manager.connect<EvBatched>(&a, [&](int v) { sum_a += v; });
+    manager.connect<EvChainStep>(&b, [&](int v) { sum_b += v; });
+
+    std::thread ra([&] { a.run(); });
+    std::thread rb([&] { b.run(); });
+
+    {
+        CormanManager::BatchScope batch(64);
+        EXPECT_TRUE(CormanManager::batching());
+        for (int i = 1; i <= 1000; ++i) {
+            manager.gen<EvBatched>(i);
+            manager.gen<EvChainStep>(i);
+        }
+    }
+    EXPECT_FALSE(CormanManager::batching());
+
+    while (sum_a != 500500 || sum_b != 500500) std::this_thread::yield();
+    a.stop();
+    b.stop();
+    ra.join();
+    rb.join();
+
+    EXPECT_EQ(a.posts.load(), 0);
+    EXPECT_EQ(a.batches.load(), 16);   // 15 full batches of 64 plus the remainder
+    EXPECT_EQ(b.batches.load(), 16);
+}
+
+TEST(ProducerBatchingTest, HoldsEventsUntilFlush) {
+    CormanManager manager;
+    CountingLoop loop("batch-flush", manager);
+    std::atomic<int> handled{0};
+    manager.connect<EvBatched>(&loop, [&](int) { handled++; });
+    std::thread runner([&] { loop.run(); });
+
+    CormanManager::enable_batching(64);
+    for (int i = 0; i < 10; ++i) manager.gen<EvBatched>(i);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(handled.load(), 0);
+
+    CormanManager::flush();
+    while (handled != 10) std::this_thread::yield();
+    EXPECT_EQ(loop.batches.load(), 1);
+
+    CormanManager::disable_batching();
+    loop.stop();
+    runner.join();
+}
+
+TEST(ProducerBatchingTest, ReconnectInvalidatesRouteCache) {
+    CormanManager manager;
+    CountingLoop first("route-1", manager);
+    CountingLoop second("route-2", manager);
+    std::atomic<int> on_first{0};
+    std::atomic<int> on_second{0};
+    manager.connect<EvBatched>(&first, [&](int) { on_first++; });
+
+    std::thread r1([&] { first.run(); });
+    std::thread r2([&] { second.run(); });
+
+    CormanManager::BatchScope batch(1);
+    manager.gen<EvBatched>(0);
+    manager.connect<EvBatched>(&second, [&](int) { on_second++; });
+    manager.gen<EvBatched>(1);
+
+    while (on_first + on_second != 2) std::this_thread::yield();
+    EXPECT_EQ(on_first.load(), 1);
+    EXPECT_EQ(on_second.load(), 1);
+
+    first.stop();
+    second.stop();
+    r1.join();
+    r2.join();
+}
+
+// Runs handlers on the posting thread.
+class DirectLoop : public EventLoopInterface {
+public:
+    void post(size_t tag, void* data) override { callbacks[tag](data); }
+    void connect(size_t tag, Callback cb) override { callbacks[tag] = cb; }
+    void run() override {}
+
+    std::unordered_map<size_t, Callback> callbacks;
+};
+
+TEST(ProducerBatchingTest, RebuiltManagerDoesNotReuseCachedRoutes) {
+    // Same address, same number of connects: only the epoch tells them apart.
+    alignas(CormanManager) unsigned char storage[sizeof(CormanManager)];
+    DirectLoop loops[2];
+    int handled[2] = {0, 0};
+
+    CormanManager::BatchScope batch(1);
+    for (int round = 0; round < 2; ++round) {
+        auto* manager = new (storage) CormanManager;
+        manager->connect<EvBatched>(&loops[round], [&handled, round](int) { handled[round]++; });
+        manager->gen<EvBatched>(round);
+        manager->~CormanManager();
+    }
+    EXPECT_EQ(handled[0], 1);
+    EXPECT_EQ(handled[1], 1);
+}
+
+OSKA_DEFINE_EVENT(EvSample, int, double)
+
+// Queues everything posted while it is held, so a test controls what one
+// drain sees.
+class HeldLoop {
+public:
+    explicit HeldLoop(EpollEventLoop& loop) : loop_(loop) {
+        loop_.post_task([this] {
+            while (held_) std::this_thread::yield();
+        });
+    }
+    void release() { held_ = false; }
+
+private:
+    EpollEventLoop& loop_;
+    std::atomic<bool> held_{true};
+};
+
+TEST(BatchHandlerTest, GroupsConsecutiveEventsOfOneTag) {
+    CormanManager manager;
+    EpollEventLoop loop("batch-handler", manager);
+
+    std::vector<std::string> order;
+    std::vector<size_t> runs;
+    double total = 0;
+    manager.connect_batch<EvSample>(&loop, [&](const EventBatch<EvSample>& batch) {
+        runs.push_back(batch.size());
+        const auto& ids = batch.column<0>();
+        const auto& values = batch.column<1>();
+        ASSERT_EQ(ids.size(), batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            EXPECT_EQ(ids[i], std::get<0>(batch[i]));
+            total += values[i];
+            order.push_back("S" + std::to_string(ids[i]));
+        }
+    });
+    manager.connect<EvEpollWork>(&loop, [&](int v) { order.push_back("W" + std::to_string(v)); });
+
+    std::thread runner([&] { loop.run(); });
+    HeldLoop hold(loop);
+    for (int i = 0; i < 300; ++i) manager.gen<EvSample>(i, 0.5);
+    manager.gen<EvEpollWork>(0);
+    manager.gen<EvSample>(300, 0.5);
+    hold.release();
+
+    loop.stop();
+    runner.join();
+
+    // Runs stop at kMaxRun and at the first event of another tag.
+    EXPECT_EQ(runs, (std::vector<size_t>{EpollEventLoop::kMaxRun, 300 - EpollEventLoop::kMaxRun, 1}));
+    EXPECT_DOUBLE_EQ(total, 301 * 0.5);
+    ASSERT_EQ(order.size(), 302u);
+    EXPECT_EQ(order[299], "S299");
+    EXPECT_EQ(order[300], "W0");
+    EXPECT_EQ(order[301], "S300");
+}
+
+TEST(BatchHandlerTest, ConnectReplacesBatchHandler) {
+    CormanManager manager;
+    EpollEventLoop loop("batch-replace", manager);
+    std::atomic<int> batched{0};
+    std::atomic<int> single{0};
+    manager.connect_batch<EvSample>(&loop, [&](const EventBatch<EvSample>& batch) {
+        batched += static_cast<int>(batch.size());
+    });
+    manager.connect<EvSample>(&loop, [&](int, double) { single++; });
+
+    std::thread runner([&] { loop.run(); });
+    for (int i = 0; i < 10; ++i) manager.gen<EvSample>(i, 1.0);
+    loop.stop();
+    runner.join();
+
+    EXPECT_EQ(batched.load(), 0);
+    EXPECT_EQ(single.load(), 10);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include "oska_epoll_loop.hpp"
+
+using namespace oska;
+
+struct Counted {
+    int value = 0;
+    static inline std::atomic<int> copies{0};
+
+    explicit Counted(int v = 0) : value(v) {}
+    Counted(const Counted& other) : value(other.value) { copies++; }
+    Counted(Counted&& other) noexcept : value(other.value) {}
+    Counted& operator=(const Counted&) = default;
+};
+
+OSKA_DEFINE_EVENT(EvReading, Counted)
+OSKA_DEFINE_EVENT(EvOrder, int, int)   // venue, quantity
+
+class FilterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (auto* loop : {&a, &b, &c}) threads.emplace_back([loop] { loop->run(); });
+    }
+
+    void TearDown() override {
+        for (auto* loop : {&a, &b, &c}) loop->stop();
+        for (auto& t : threads) t.join();
+    }
+
+    CormanManager manager;
+    EpollEventLoop a{"filter-a", manager};
+    EpollEventLoop b{"filter-b", manager};
+    EpollEventLoop c{"filter-c", manager};
+    std::vector<std::thread> threads;
+};
+
+TEST_F(FilterTest, RejectedEventsAreNeverCopied) {
+    std::atomic<int> sum{0};
+    std::atomic<int> handled{0};
+    manager.connect<EvReading>(&a, [&](const Counted& r) {
+        sum += r.value;
+        handled++;
+    }, [](const Counted& r) { return r.value % 2 == 0; });
+
+    Counted::copies = 0;
+    for (int i = 0; i < 10; ++i) {
+        Counted reading(i);
+        manager.gen<EvReading>(reading);
+    }
+    while (handled != 5) std::this_thread::yield();
+
+    EXPECT_EQ(sum.load(), 0 + 2 + 4 + 6 + 8);
+    EXPECT_EQ(manager.filtered_out(), 5u);
+    EXPECT_EQ(Counted::copies.load(), 5);
+}
+
+TEST_F(FilterTest, ConnectWithoutFilterRemovesIt) {
+    std::atomic<int> handled{0};
+    manager.connect<EvReading>(&a, [&](const Counted&) { handled++; }, [](const Counted&) { return false; });
+    manager.gen<EvReading>(Counted(1));
+    manager.connect<EvReading>(&a, [&](const Counted&) { handled++; });
+    manager.gen<EvReading>(Counted(2));
+
+    while (handled != 1) std::this_thread::yield();
+    EXPECT_EQ(manager.filtered_out(), 1u);
+}
+
+TEST_F(FilterTest, FilterAddedLaterReachesCachingThreads) {
+    std::atomic<int> handled{0};
+    manager.connect<EvOrder>(&a, [&](int, int) { handled++; });
+    manager.connect<EvReading>(&a, [&](const Counted&) { handled++; }, [](const Counted&) { return true; });
+
+    // This thread has now cached "no filter" for EvOrder.
+    manager.gen<EvOrder>(0, 1);
+    while (handled != 1) std::this_thread::yield();
+    std::thread([&] {
+        manager.connect<EvOrder>(&b, [&](int, int) { handled++; }, [](int venue, int) { return venue != 0; });
+    }).join();
+    manager.gen<EvOrder>(0, 1);
+    manager.gen<EvOrder>(1, 1);
+
+    while (handled != 2) std::this_thread::yield();
+    EXPECT_EQ(manager.filtered_out(), 1u);
+}
+
+TEST_F(FilterTest, IndexedKeysRouteToTheirLoops) {
+    std::atomic<int> on_a{0};
+    std::atomic<int> on_b{0};
+    std::atomic<int> rest{0};
+    manager.connect_where<EvOrder, 0>(1, &a, [&](int venue, int qty) {
+        EXPECT_EQ(venue, 1);
+        EXPECT_EQ(EventLoopInterface::current(), &a);
+        on_a += qty;
+    });
+    manager.connect_where<EvOrder, 0>(2, &b, [&](int venue, int qty) {
+        EXPECT_EQ(venue, 2);
+        EXPECT_EQ(EventLoopInterface::current(), &b);
+        on_b += qty;
+    });
+    manager.connect<EvOrder>(&c, [&](int, int qty) {
+        EXPECT_EQ(EventLoopInterface::current(), &c);
+        rest += qty;
+    });
+
+    for (int i = 0; i < 100; ++i) manager.gen<EvOrder>(i % 4, 1);
+    while (on_a + on_b + rest != 100) std::this_thread::yield();
+    EXPECT_EQ(on_a.load(), 25);
+    EXPECT_EQ(on_b.load(), 25);
+    EXPECT_EQ(rest.load(), 50);
+
+    manager.disconnect_where<EvOrder, 0>(1);
+    manager.gen<EvOrder>(1, 1);
+    while (rest != 51) std::this_thread::yield();
+    EXPECT_EQ(on_a.load(), 25);
+}
+
+TEST_F(FilterTest, DisconnectedKeysKeepTheirQueuedEvents) {
+    // Keys come and go while their events are still queued; no event may
+    // reach the handler of a later key.
+    EpollEventLoop idle("filter-idle", manager);
+    constexpr int kKeys = 32;
+    std::atomic<int> handled{0};
+    std::atomic<int> misrouted{0};
+    for (int key = 0; key < kKeys; ++key) {
+        manager.connect_where<EvOrder, 0>(key, &idle, [&, key](int venue, int) {
+            if (venue != key) misrouted++;
+            handled++;
+        });
+        manager.gen<EvOrder>(key, 0);
+        manager.gen<EvOrder>(key, 1);
+        manager.disconnect_where<EvOrder, 0>(key);
+        manager.gen<EvOrder>(key, 2);     // dropped; also releases the cached route
+    }
+
+    std::thread t([&] { idle.run(); });
+    while (handled != 2 * kKeys) std::this_thread::yield();
+    idle.stop();
+    t.join();
+    EXPECT_EQ(handled.load(), 2 * kKeys);
+    EXPECT_EQ(misrouted.load(), 0);
+}
+
+TEST_F(FilterTest, UnmatchedKeysWithoutBindingAreDropped) {
+    std::atomic<int> handled{0};
+    manager.connect_where<EvOrder, 1>(5, &a, [&](int, int) { handled++; });
+
+    manager.gen<EvOrder>(0, 4);
+    manager.gen<EvOrder>(0, 5);
+    manager.gen<EvOrder>(0, 6);
+    while (handled != 1) std::this_thread::yield();
+
+    // Indexing another argument replaces the index.
+    manager.connect_where<EvOrder, 0>(0, &b, [&](int, int) { handled += 10; });
+    manager.gen<EvOrder>(0, 5);
+    while (handled != 11) std::this_thread::yield();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
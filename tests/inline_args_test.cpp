@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "oska_events.hpp"
+#include "oska_actor.hpp"
+
+using namespace oska;
+
+// Counts allocations made by this thread while `counting` is set.
+static thread_local bool counting = false;
+static thread_local size_t allocations = 0;
+
+void* operator new(size_t size) {
+    if (counting) allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static size_t allocations_in(const std::function<void()>& fn) {
+    allocations = 0;
+    counting = true;
+    fn();
+    counting = false;
+    return allocations;
+}
+
+OSKA_DEFINE_EVENT(EvLine, int, InlineString)
+OSKA_DEFINE_EVENT(EvStdLine, int, std::string)
+OSKA_DEFINE_EVENT(EvFrame, InlineString, InlineBytes, int)
+OSKA_DEFINE_QUERY_EVENT(QryLength, size_t, InlineString)
+
+static_assert(!ArgsCodec<std::tuple<int, InlineString>>::packable, "inline arguments point into their payload");
+static_assert(ArgsCodec<std::tuple<int, double>>::packable, "plain arguments stay packable");
+static_assert(ArgsCodec<std::tuple<char[16], uint64_t>>::packable, "fixed arrays stay packable");
+// Arguments holding an address would be replayed into another address space,
+// so journal::Replayer::add() and the remote loops reject them at compile time.
+static_assert(!ArgsCodec<std::tuple<const char*>>::packable, "pointers are not packable");
+static_assert(!ArgsCodec<std::tuple<int, int*>>::packable, "pointers are not packable");
+static_assert(!ArgsCodec<std::tuple<int std::pair<int, int>::*>>::packable, "member pointers are not packable");
+static_assert(!ArgsCodec<std::tuple<std::string_view>>::packable, "views are not packable");
+static_assert(!ArgsCodec<std::tuple<const char* [2]>>::packable, "arrays of pointers are not packable");
+
+// Queues events until the test runs or drops them.
+class QueueLoop : public EventLoopInterface {
+public:
+    QueueLoop() { queue.reserve(64); }
+
+    void post(size_t tag, void* data) override { queue.push_back(EventWrapper(tag, data)); }
+    void post(const EventWrapper& ev) override { queue.push_back(ev); }
+    void connect(size_t tag, Callback cb) override { callbacks[tag] = cb; }
+    void run() override {
+        for (auto& ev : queue) callbacks[ev.tag](ev.data);
+        queue.clear();
+    }
+
+    void drop_all() {
+        for (auto& ev : queue) discard_event(ev);
+        queue.clear();
+    }
+
+    std::vector<EventWrapper> queue;
+    std::unordered_map<size_t, Callback> callbacks;
+};
+
+TEST(InlineArgsTest, BytesAreCopiedIntoThePayload) {
+    CormanManager manager;
+    QueueLoop loop;
+    std::string seen;
+    manager.connect<EvLine>(&loop, [&](int n, InlineString line) { seen = std::to_string(n) + ":" + line.str(); });
+
+    std::string buffer = "a line well past the small string buffer";
+    manager.gen<EvLine>(1, InlineString(buffer));
+    buffer.assign(buffer.size(), 'x');     // the caller reuses its buffer
+    loop.run();
+
+    EXPECT_EQ(seen, "1:a line well past the small string buffer");
+}
+
+TEST(InlineArgsTest, OneAllocationPerEvent) {
+    CormanManager manager;
+    QueueLoop loop;
+    manager.connect<EvLine>(&loop, [](int, InlineString) {});
+    manager.connect<EvStdLine>(&loop, [](int, std::string) {});
+    manager.gen<EvLine>(0, InlineString("warm"));
+    manager.gen<EvStdLine>(0, std::string("warm"));
+    loop.run();
+
+    std::string text(200, 'q');
+    EXPECT_EQ(allocations_in([&] { manager.gen<EvLine>(1, InlineString(text)); }), 1u);
+    EXPECT_GE(allocations_in([&] { manager.gen<EvStdLine>(1, text); }), 2u);
+    loop.run();
+}
+
+TEST(InlineArgsTest, SeveralAndEmptyInlineArguments) {
+    CormanManager manager;
+    QueueLoop loop;
+    std::string name;
+    std::vector<uint8_t> body;
+    int tail = 0;
+    manager.connect<EvFrame>(&loop, [&](InlineString n, InlineBytes b, int t) {
+        name = n.str();
+        body = b.to_vector();
+        tail = t;
+    });
+
+    const uint8_t raw[] = {1, 2, 3, 250};
+    manager.gen<EvFrame>(InlineString("hdr"), InlineBytes(raw, sizeof(raw)), 9);
+    loop.run();
+    EXPECT_EQ(name, "hdr");
+    EXPECT_EQ(body, std::vector<uint8_t>({1, 2, 3, 250}));
+    EXPECT_EQ(tail, 9);
+
+    manager.gen<EvFrame>(InlineString(), InlineBytes(), 4);
+    loop.run();
+    EXPECT_EQ(name, "");
+    EXPECT_TRUE(body.empty());
+    EXPECT_EQ(tail, 4);
+}
+
+TEST(InlineArgsTest, DroppedEventsFreeTheirBlock) {
+    CormanManager manager;
+    QueueLoop loop;
+    manager.connect<EvLine>(&loop, [](int, InlineString) { FAIL() << "dropped events must not run"; });
+
+    for (int i = 0; i < 10; ++i) manager.gen<EvLine>(i, InlineString("dropped"));
+    loop.drop_all();
+}
+
+TEST(InlineArgsTest, QueryEventsCarryInlineArguments) {
+    CormanManager manager;
+    QueueLoop loop;
+    manager.connect<QryLength>(&loop, [](InlineString s) { return s.size(); });
+
+    std::string key = "twelve bytes";
+    auto reply = manager.call<QryLength>(InlineString(key));
+    key.clear();
+    loop.run();
+    EXPECT_EQ(reply.get(), std::optional<size_t>(12));
+}
+
+struct Sink : Actor {
+    std::string last;
+};
+
+TEST(InlineArgsTest, ActorsReceiveInlineArguments) {
+    ActorSystem actors(ActorSystem::Options{1, 4});
+    actors.connect<EvLine, Sink>([](Sink& self, int, InlineString line) { self.last = line.str(); });
+
+    Sink sink;
+    {
+        std::string temp = "from a temporary that is gone before the handler runs";
+        actors.gen<EvLine>(sink, 0, InlineString(temp));
+    }
+    actors.wait_idle();
+    EXPECT_EQ(sink.last, "from a temporary that is gone before the handler runs");
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "channel.hpp"
+#include "oska_pipeline.hpp"
+#include "sharded_channel.hpp"
+
+using namespace oska;
+using Result = ChannelBase::Result;
+
+template <typename Ch>
+static std::vector<channel_value_t<Ch>> drain(Ch& ch) {
+    std::vector<channel_value_t<Ch>> out;
+    while (auto item = ch.get()) out.push_back(*item);
+    return out;
+}
+
+TEST(PipelineTest, OrderedMapKeepsInputOrder) {
+    Pipeline p;
+    auto& in = p.channel<int, 16>();
+    auto& out = p.channel<std::string, 16>();
+    p.map("fmt", in, out, [](int i) {
+        // Uneven work so later items often finish first.
+        std::this_thread::sleep_for(std::chrono::microseconds((i * 7919) % 200));
+        return std::to_string(i);
+    }, 4);
+    p.start();
+
+    std::thread feeder([&] {
+        for (int i = 0; i < 300; ++i) in.add(i);
+        in.close();
+    });
+    auto got = drain(out);
+    feeder.join();
+    p.wait();
+
+    ASSERT_EQ(got.size(), 300u);
+    for (int i = 0; i < 300; ++i) EXPECT_EQ(got[i], std::to_string(i));
+}
+
+TEST(PipelineTest, UnorderedMapFilterChain) {
+    Pipeline p;
+    auto& in = p.channel<int, 64>();
+    auto& squared = p.channel<long, 64>();
+    auto& even = p.channel<long, 64>();
+    p.map("square", in, squared, [](int i) { return static_cast<long>(i) * i; }, 3, Pipeline::Order::UNORDERED);
+    p.filter("even", squared, even, [](const long& v) { return v % 2 == 0; });
+    p.start();
+
+    std::thread feeder([&] {
+        for (int i = 1; i <= 1000; ++i) in.add(i);
+        in.close();
+    });
+    long sum = 0;
+    for (long v : drain(even)) sum += v;
+    feeder.join();
+    p.wait();
+
+    long expected = 0;
+    for (long i = 2; i <= 1000; i += 2) expected += i * i;
+    EXPECT_EQ(sum, expected);
+
+    auto stats = p.stats();
+    ASSERT_EQ(stats.size(), 2u);
+    EXPECT_EQ(stats[0].name, "square");
+    EXPECT_EQ(stats[0].workers, 3u);
+    EXPECT_EQ(stats[0].in, 1000u);
+    EXPECT_EQ(stats[0].out, 1000u);
+    EXPECT_EQ(stats[1].in, 1000u);
+    EXPECT_EQ(stats[1].out, 500u);
+    EXPECT_TRUE(stats[1].done);
+}
+
+TEST(PipelineTest, MergeClosesAfterLastInput) {
+    Pipeline p;
+    auto& a = p.channel<int, 8>();
+    auto& b = p.channel<int, 8>();
+    auto& out = p.channel<int, 8>();
+    p.merge("join", std::vector<Channel<int, 8>*>{&a, &b}, out);
+    p.start();
+
+    std::thread fa([&] { for (int i = 0; i < 100; ++i) a.add(1); a.close(); });
+    std::thread fb([&] { for (int i = 0; i < 50; ++i) b.add(2); b.close(); });
+    int sum = 0;
+    for (int v : drain(out)) sum += v;
+    fa.join();
+    fb.join();
+    p.wait();
+    EXPECT_EQ(sum, 200);
+}
+
+TEST(PipelineTest, SplitRoundRobinAndByKey) {
+    Pipeline p;
+    auto& in = p.channel<int, 8>();
+    auto& rr0 = p.channel<int, 64>();
+    auto& rr1 = p.channel<int, 64>();
+    p.split("deal", in, std::vector<Channel<int, 64>*>{&rr0, &rr1});
+
+    auto& keyed_in = p.channel<int, 8>();
+    ShardedChannel<int, 64, 2> k0, k1, k2;
+    p.split_by_key("by-mod", keyed_in, std::vector<ShardedChannel<int, 64, 2>*>{&k0, &k1, &k2},
+                   [](const int& v) { return v % 5; });
+    p.start();
+
+    for (int i = 0; i < 40; ++i) in.add(i);
+    in.close();
+    for (int i = 0; i < 50; ++i) keyed_in.add(i);
+    keyed_in.close();
+    p.wait();
+
+    EXPECT_EQ(drain(rr0).size(), 20u);
+    EXPECT_EQ(drain(rr1).size(), 20u);
+
+    size_t total = 0;
+    for (auto* ch : {&k0, &k1, &k2}) {
+        auto values = drain(*ch);
+        total += values.size();
+        for (int v : values) {
+            // Every value with the same key landed on this output.
+            EXPECT_EQ(std::hash<int>()(v % 5) % 3, std::hash<int>()(values.front() % 5) % 3);
+        }
+    }
+    EXPECT_EQ(total, 50u);
+}
+
+TEST(PipelineTest, DownstreamCloseReachesProducers) {
+    Pipeline p;
+    auto& in = p.channel<int, 4>();
+    auto& mid = p.channel<int, 4>();
+    auto& out = p.channel<int, 4>();
+    p.map("a", in, mid, [](int i) { return i; });
+    p.map("b", mid, out, [](int i) { return i; }, 2);
+    p.start();
+
+    std::thread consumer([&] {
+        for (int i = 0; i < 10; ++i) out.get();
+        out.close();
+    });
+
+    Result result = Result::OK;
+    int sent = 0;
+    while ((result = in.add(sent)) == Result::OK) sent++;
+    EXPECT_EQ(result, Result::CLOSED);
+    EXPECT_GE(sent, 10);
+
+    consumer.join();
+    p.wait();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
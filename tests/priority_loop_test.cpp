@@ -0,0 +1,278 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include "oska_priority_loop.hpp"
+
+using namespace oska;
+
+OSKA_DEFINE_PRIORITY_EVENT(EvCancel, Priority::HIGH, int)
+OSKA_DEFINE_EVENT(EvRequest, int)
+OSKA_DEFINE_PRIORITY_EVENT(EvBulkRow, Priority::BULK, int)
+OSKA_DEFINE_EVENT(EvQuote, std::shared_ptr<int>)
+
+static_assert(event_priority<EvCancel>::value == Priority::HIGH, "declared priority");
+static_assert(event_priority<EvRequest>::value == Priority::NORMAL, "default priority");
+
+class PriorityLoopTest : public ::testing::Test {
+protected:
+    void bind(PriorityEventLoop& loop) {
+        Corman.connect<EvCancel>(&loop, [this](int i) { order.push_back("H" + std::to_string(i)); });
+        Corman.connect<EvRequest>(&loop, [this](int i) { order.push_back("N" + std::to_string(i)); });
+        Corman.connect<EvBulkRow>(&loop, [this](int i) { order.push_back("B" + std::to_string(i)); });
+    }
+
+    // Everything is queued up front, then drained on this thread.
+    void drain(PriorityEventLoop& loop) {
+        loop.stop();
+        loop.run();
+    }
+
+    std::vector<std::string> order;
+};
+
+TEST_F(PriorityLoopTest, StrictServesHighLaneFirst) {
+    PriorityEventLoop loop;
+    bind(loop);
+
+    for (int i = 0; i < 1000; ++i) Corman.gen<EvBulkRow>(i);
+    Corman.gen<EvRequest>(0);
+    Corman.gen<EvCancel>(0);
+    EXPECT_EQ(loop.depth(Priority::BULK), 1000u);
+
+    drain(loop);
+
+    ASSERT_EQ(order.size(), 1002u);
+    EXPECT_EQ(order[0], "H0");
+    EXPECT_EQ(order[1], "N0");
+    EXPECT_EQ(order[2], "B0");
+    EXPECT_EQ(loop.stats(Priority::BULK).max_depth, 1000u);
+    EXPECT_EQ(loop.stats(Priority::HIGH).handled, 1u);
+}
+
+TEST_F(PriorityLoopTest, WeightedDrainFollowsWeights) {
+    PriorityEventLoop::Options options;
+    options.drain = PriorityEventLoop::Drain::WEIGHTED;
+    options.weight = {{1, 4, 1}};
+    PriorityEventLoop loop(options);
+    bind(loop);
+
+    for (int i = 0; i < 8; ++i) Corman.gen<EvRequest>(i);
+    for (int i = 0; i < 2; ++i) Corman.gen<EvBulkRow>(i);
+
+    drain(loop);
+
+    std::vector<std::string> expected = {"N0", "N1", "N2", "N3", "B0", "N4", "N5", "N6", "N7", "B1"};
+    EXPECT_EQ(order, expected);
+}
+
+TEST_F(PriorityLoopTest, StarvationLimitPromotesLowerLane) {
+    PriorityEventLoop::Options options;
+    options.starvation_limit = 3;
+    PriorityEventLoop loop(options);
+    bind(loop);
+
+    for (int i = 0; i < 6; ++i) Corman.gen<EvCancel>(i);
+    Corman.gen<EvBulkRow>(0);
+
+    drain(loop);
+
+    std::vector<std::string> expected = {"H0", "H1", "H2", "B0", "H3", "H4", "H5"};
+    EXPECT_EQ(order, expected);
+    EXPECT_EQ(loop.stats(Priority::BULK).promoted, 1u);
+}
+
+TEST_F(PriorityLoopTest, FullBulkLaneDoesNotBlockHighProducer) {
+    PriorityEventLoop::Options options;
+    options.capacity = {{4, 4, 2}};
+    PriorityEventLoop loop(options);
+    bind(loop);
+
+    Corman.gen<EvBulkRow>(0);
+    Corman.gen<EvBulkRow>(1);
+
+    // This producer blocks on the full BULK lane ...
+    std::thread bulk_producer([] { Corman.gen<EvBulkRow>(2); });
+
+    // ... while control traffic still gets through.
+    Corman.gen<EvCancel>(0);
+    EXPECT_EQ(loop.depth(Priority::HIGH), 1u);
+
+    std::thread runner([&] { loop.run(); });
+    bulk_producer.join();
+    loop.stop();
+    runner.join();
+
+    ASSERT_EQ(order.size(), 4u);
+    EXPECT_EQ(order[0], "H0");
+}
+
+TEST_F(PriorityLoopTest, HandlerFloodingItsOwnLaneDoesNotBlock) {
+    PriorityEventLoop::Options options;
+    options.capacity = {{4, 4, 4}};
+    PriorityEventLoop loop(options);
+
+    std::atomic<int> handled{0};
+    Corman.connect<EvRequest>(&loop, [&](int i) {
+        if (i == 0) {
+            for (int j = 1; j <= 50; ++j) Corman.gen<EvRequest>(j);
+            CormanManager::BatchScope batching(8);     // sent with post_batch() from this thread
+            for (int j = 51; j <= 100; ++j) Corman.gen<EvRequest>(j);
+        }
+        handled++;
+    });
+    std::thread runner([&] { loop.run(); });
+
+    Corman.gen<EvRequest>(0);
+    while (handled.load() != 101) std::this_thread::yield();
+    loop.stop();
+    runner.join();
+
+    auto stats = loop.stats(Priority::NORMAL);
+    EXPECT_EQ(stats.handled, 101u);
+    EXPECT_EQ(stats.local, 100u);
+}
+
+TEST_F(PriorityLoopTest, UnboundEventsAreDiscarded) {
+    struct EvUnbound {};
+    PriorityEventLoop loop;
+    auto quote = std::make_shared<int>(1);
+    EventWrapper ev(TypeId<EvUnbound>::value(), new std::shared_ptr<int>(quote));
+    ev.discard = [](void* data) { delete static_cast<std::shared_ptr<int>*>(data); };
+    loop.post(ev);
+    EXPECT_EQ(quote.use_count(), 2);
+
+    drain(loop);
+    EXPECT_EQ(quote.use_count(), 1);
+}
+
+TEST_F(PriorityLoopTest, EdfServesEarliestDeadlineFirst) {
+    PriorityEventLoop::Options options;
+    options.deadlines = PriorityEventLoop::Deadlines::EDF;
+    PriorityEventLoop loop(options);
+    bind(loop);
+
+    auto now = std::chrono::steady_clock::now();
+    Corman.gen<EvRequest>(0);
+    Corman.gen_with_deadline<EvRequest>(now + std::chrono::seconds(30), 30);
+    Corman.gen<EvRequest>(1);
+    Corman.gen_with_deadline<EvBulkRow>(now + std::chrono::seconds(10), 10);
+    Corman.gen_with_deadline<EvRequest>(now + std::chrono::seconds(20), 20);
+
+    drain(loop);
+
+    std::vector<std::string> expected = {"B10", "N20", "N30", "N0", "N1"};
+    EXPECT_EQ(order, expected);
+    auto stats = loop.deadline_stats();
+    EXPECT_EQ(stats.posted, 3u);
+    EXPECT_EQ(stats.handled, 3u);
+    EXPECT_EQ(stats.max_depth, 3u);
+}
+
+TEST_F(PriorityLoopTest, EdfKeepsHighLaneAheadOfDeadlineBacklog) {
+    PriorityEventLoop::Options options;
+    options.deadlines = PriorityEventLoop::Deadlines::EDF;
+    PriorityEventLoop loop(options);
+    bind(loop);
+
+    auto later = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    for (int i = 0; i < 500; ++i) Corman.gen_with_deadline<EvRequest>(later, i);
+    Corman.gen<EvRequest>(1000);
+    Corman.gen<EvCancel>(0);
+
+    drain(loop);
+
+    ASSERT_EQ(order.size(), 502u);
+    EXPECT_EQ(order[0], "H0");
+    EXPECT_EQ(order[1], "N0");      // NORMAL deadline events still beat the NORMAL lane
+    EXPECT_EQ(loop.stats(Priority::HIGH).promoted, 0u);
+}
+
+TEST_F(PriorityLoopTest, EdfDropsExpiredEvents) {
+    PriorityEventLoop::Options options;
+    options.deadlines = PriorityEventLoop::Deadlines::EDF;
+    PriorityEventLoop loop(options);
+    int handled = 0;
+    Corman.connect<EvQuote>(&loop, [&](std::shared_ptr<int>) { handled++; });
+
+    auto quote = std::make_shared<int>(42);
+    Corman.gen_with_deadline<EvQuote>(std::chrono::steady_clock::now() - std::chrono::milliseconds(1), quote);
+    Corman.gen_with_deadline<EvQuote>(std::chrono::steady_clock::now() + std::chrono::seconds(10), quote);
+    EXPECT_EQ(quote.use_count(), 3);
+
+    drain(loop);
+
+    EXPECT_EQ(handled, 1);
+    EXPECT_EQ(quote.use_count(), 1);   // the dropped payload was freed
+    auto stats = loop.deadline_stats();
+    EXPECT_EQ(stats.dropped, 1u);
+    EXPECT_EQ(stats.handled, 1u);
+}
+
+TEST_F(PriorityLoopTest, EdfDivertsExpiredEvents) {
+    std::vector<size_t> diverted;
+    PriorityEventLoop::Options options;
+    options.deadlines = PriorityEventLoop::Deadlines::EDF;
+    options.expired = PriorityEventLoop::Expired::DIVERT;
+    options.on_expired = [&](const EventWrapper& ev) {
+        diverted.push_back(ev.tag);
+        discard_event(ev);
+    };
+    PriorityEventLoop loop(options);
+    bind(loop);
+
+    Corman.gen_with_deadline<EvCancel>(std::chrono::steady_clock::now() - std::chrono::seconds(1), 7);
+    drain(loop);
+
+    EXPECT_TRUE(order.empty());
+    ASSERT_EQ(diverted.size(), 1u);
+    EXPECT_EQ(diverted[0], TypeId<EvCancel>::value());
+    EXPECT_EQ(loop.deadline_stats().diverted, 1u);
+}
+
+TEST_F(PriorityLoopTest, DeadlinesIgnoredByDefault) {
+    PriorityEventLoop loop;
+    bind(loop);
+
+    auto past = std::chrono::steady_clock::now() - std::chrono::seconds(1);
+    Corman.gen<EvRequest>(0);
+    Corman.gen_with_deadline<EvRequest>(past, 1);
+
+    drain(loop);
+
+    std::vector<std::string> expected = {"N0", "N1"};
+    EXPECT_EQ(order, expected);
+    EXPECT_EQ(loop.deadline_stats().posted, 0u);
+}
+
+TEST_F(PriorityLoopTest, BatchHandlerTakesRunsWithinWeights) {
+    PriorityEventLoop::Options options;
+    options.drain = PriorityEventLoop::Drain::WEIGHTED;
+    options.weight = {{1, 4, 1}};
+    PriorityEventLoop loop(options);
+    bind(loop);
+
+    std::vector<size_t> runs;
+    Corman.connect_batch<EvRequest>(&loop, [this, &runs](const EventBatch<EvRequest>& batch) {
+        runs.push_back(batch.size());
+        for (int i : batch.column<0>()) order.push_back("N" + std::to_string(i));
+    });
+
+    for (int i = 0; i < 8; ++i) Corman.gen<EvRequest>(i);
+    for (int i = 0; i < 2; ++i) Corman.gen<EvBulkRow>(i);
+
+    drain(loop);
+
+    std::vector<std::string> expected = {"N0", "N1", "N2", "N3", "B0", "N4", "N5", "N6", "N7", "B1"};
+    EXPECT_EQ(order, expected);
+    EXPECT_EQ(runs, (std::vector<size_t>{4, 4}));
+    EXPECT_EQ(loop.stats(Priority::NORMAL).handled, 8u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
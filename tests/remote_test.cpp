@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include "oska_epoll_loop.hpp"
+#include "oska_remote.hpp"
+
+using namespace oska;
+
+OSKA_DEFINE_EVENT(EvFill, uint64_t, double)
+OSKA_DEFINE_EVENT(EvHeartbeat, int)
+OSKA_DEFINE_EVENT(EvUnknownThere, int)
+OSKA_DEFINE_EVENT(EvRawText, int, const char*)
+OSKA_DEFINE_EVENT(EvText, int, InlineString)
+OSKA_DEFINE_EVENT(EvSymbol, char[8], double)
+
+// remote.bind<EvRawText>() and server.accept<EvRawText>() do not compile: the
+// receiver would dereference an address from the sending process.
+static_assert(remote::sendable<EvFill>, "plain arguments cross");
+static_assert(remote::sendable<EvSymbol>, "fixed arrays cross");
+static_assert(!remote::sendable<EvRawText>, "pointer arguments stay in their process");
+static_assert(!remote::sendable<EvText>, "inline arguments stay in their process");
+
+static std::string socket_path(const char* name) {
+    return "/tmp/oska-" + std::string(name) + "-" + std::to_string(::getpid()) + ".sock";
+}
+
+// Two managers stand in for the two processes.
+class RemoteTest : public ::testing::Test {
+protected:
+    CormanManager sender;
+    CormanManager receiver;
+};
+
+TEST_F(RemoteTest, EventsCrossTheSocketInOrder) {
+    std::string path = socket_path("order");
+    RemoteEventServer server(path, receiver);
+    ASSERT_TRUE(server.is_open());
+    server.accept<EvFill>();
+
+    EpollEventLoop local("local", receiver);
+    std::vector<uint64_t> ids;
+    double total = 0;
+    std::atomic<int> handled{0};
+    receiver.connect<EvFill>(&local, [&](uint64_t id, double px) {
+        ids.push_back(id);
+        total += px;
+        handled++;
+    });
+    std::thread local_thread([&] { local.run(); });
+    std::thread server_thread([&] { server.run(); });
+
+    RemoteEventLoop remote(path);
+    ASSERT_TRUE(remote.is_open());
+    remote.bind<EvFill>(sender);
+    std::thread sender_thread([&] { remote.run(); });
+
+    constexpr int kEvents = 5000;
+    for (int i = 0; i < kEvents; ++i) sender.gen<EvFill>(static_cast<uint64_t>(i), 0.5);
+
+    while (handled != kEvents) std::this_thread::yield();
+    remote.stop();
+    sender_thread.join();
+    server.stop();
+    server_thread.join();
+    local.stop();
+    local_thread.join();
+
+    ASSERT_EQ(ids.size(), static_cast<size_t>(kEvents));
+    for (int i = 0; i < kEvents; ++i) EXPECT_EQ(ids[i], static_cast<uint64_t>(i));
+    EXPECT_DOUBLE_EQ(total, kEvents * 0.5);
+
+    auto sent = remote.stats();
+    EXPECT_EQ(sent.events, static_cast<uint64_t>(kEvents));
+    EXPECT_LT(sent.sends, sent.events);   // batched, not one syscall per event
+    EXPECT_EQ(server.stats().received, static_cast<uint64_t>(kEvents));
+}
+
+TEST_F(RemoteTest, UnacceptedEventsAreSkipped) {
+    std::string path = socket_path("skip");
+    RemoteEventServer server(path, receiver);
+    server.accept<EvHeartbeat>();
+
+    EpollEventLoop local("local", receiver);
+    std::atomic<int> beats{0};
+    receiver.connect<EvHeartbeat>(&local, [&](int) { beats++; });
+    std::thread local_thread([&] { local.run(); });
+    std::thread server_thread([&] { server.run(); });
+
+    RemoteEventLoop remote(path);
+    remote.bind<EvHeartbeat>(sender);
+    remote.bind<EvUnknownThere>(sender);
+
+    sender.gen<EvUnknownThere>(1);
+    sender.gen<EvHeartbeat>(2);
+    remote.stop();
+    remote.run();   // flushes what is queued, then returns
+
+    while (beats != 1) std::this_thread::yield();
+    while (server.stats().skipped != 1) std::this_thread::yield();
+
+    server.stop();
+    server_thread.join();
+    local.stop();
+    local_thread.join();
+    EXPECT_EQ(server.stats().connections, 1u);
+}
+
+TEST_F(RemoteTest, OversizedFrameDropsTheConnection) {
+    std::string path = socket_path("oversized");
+    RemoteEventServer server(path, receiver);
+    server.accept<EvFill>();
+    std::thread server_thread([&] { server.run(); });
+
+    sockaddr_un addr;
+    ASSERT_TRUE(remote::make_address(path, addr));
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+
+    // Claims close to 4 GB of payload; the server must not wait to buffer it.
+    journal::FrameHeader header{event_id<EvFill>::value, 0, 0xfffffff0u, 0};
+    ASSERT_EQ(::write(fd, &header, sizeof(header)), static_cast<ssize_t>(sizeof(header)));
+    char byte;
+    EXPECT_EQ(::read(fd, &byte, 1), 0);     // closed by the server
+    ::close(fd);
+
+    server.stop();
+    server_thread.join();
+    EXPECT_EQ(server.stats().rejected, 1u);
+    EXPECT_EQ(server.stats().received, 0u);
+}
+
+TEST_F(RemoteTest, MissingServerLeavesLoopClosed) {
+    RemoteEventLoop remote(socket_path("nobody"));
+    EXPECT_FALSE(remote.is_open());
+    remote.bind<EvHeartbeat>(sender);
+    sender.gen<EvHeartbeat>(1);   // dropped, payload freed
+    EXPECT_EQ(remote.stats().dropped, 1u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sharded_channel.hpp"
+
+using namespace oska;
+using Result = ChannelBase::Result;
+
+TEST(ShardedChannelTest, SingleThreadIsFifo) {
+    ShardedChannel<int, 16, 4> channel;
+    for (int i = 0; i < 10; ++i) EXPECT_EQ(channel.add(i), Result::OK);
+    for (int i = 0; i < 10; ++i) {
+        Result result;
+        auto item = channel.get(result);
+        ASSERT_EQ(result, Result::OK);
+        EXPECT_EQ(*item, i);
+    }
+}
+
+TEST(ShardedChannelTest, SpillsIntoOtherShardsBeforeFull) {
+    ShardedChannel<std::string, 4, 3> channel;
+    for (int i = 0; i < 12; ++i) EXPECT_EQ(channel.try_add(std::to_string(i)), Result::OK);
+
+    std::string keep = "kept";
+    EXPECT_EQ(channel.try_add(std::move(keep)), Result::FULL);
+    EXPECT_EQ(keep, "kept");   // not moved from on failure
+
+    auto item = std::make_unique<std::string>("ptr");
+    EXPECT_EQ(channel.try_add_ptr(std::move(item)), Result::FULL);
+    EXPECT_NE(item, nullptr);
+
+    Result result;
+    int got = 0;
+    while (channel.try_get(result)) got++;
+    EXPECT_EQ(result, Result::EMPTY);
+    EXPECT_EQ(got, 12);
+}
+
+TEST(ShardedChannelTest, StealsFromOtherShards) {
+    ShardedChannel<int, 8, 4> channel;
+    std::thread producer([&] {
+        ShardedChannel<int, 8, 4>::set_home(2);
+        for (int i = 0; i < 5; ++i) channel.add(i);
+    });
+    producer.join();
+
+    ShardedChannel<int, 8, 4>::set_home(0);
+    for (int i = 0; i < 5; ++i) {
+        auto item = channel.try_get();
+        ASSERT_NE(item, nullptr);
+        EXPECT_EQ(*item, i);
+    }
+}
+
+TEST(ShardedChannelTest, CloseDrainsThenReportsClosed) {
+    ShardedChannel<int, 8, 2> channel;
+    channel.add(1);
+    channel.add(2);
+    channel.close();
+    EXPECT_EQ(channel.add(3), Result::CLOSED);
+
+    Result result;
+    EXPECT_EQ(*channel.get(result), 1);
+    EXPECT_EQ(*channel.get(result), 2);
+    EXPECT_EQ(channel.get(result), nullptr);
+    EXPECT_EQ(result, Result::CLOSED);
+    EXPECT_EQ(channel.try_get(result), nullptr);
+    EXPECT_EQ(result, Result::CLOSED);
+}
+
+TEST(ShardedChannelTest, CloseWakesBlockedConsumers) {
+    ShardedChannel<int, 8, 2> channel;
+    std::vector<std::thread> consumers;
+    std::atomic<int> closed{0};
+    for (int i = 0; i < 3; ++i) {
+        consumers.emplace_back([&] {
+            Result result;
+            if (!channel.get(result) && result == Result::CLOSED) closed++;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    channel.close();
+    for (auto& t : consumers) t.join();
+    EXPECT_EQ(closed.load(), 3);
+}
+
+TEST(ShardedChannelTest, ManyProducersManyConsumers) {
+    constexpr int kProducers = 8;
+    constexpr int kConsumers = 4;
+    constexpr int kPerProducer = 20000;
+    ShardedChannel<int, 64, 4> channel;   // small enough to block both ways
+
+    std::atomic<long long> sum{0};
+    std::atomic<int> count{0};
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < kConsumers; ++c) {
+        consumers.emplace_back([&] {
+            Result result;
+            while (auto item = channel.get(result)) {
+                sum += *item;
+                count++;
+            }
+            EXPECT_EQ(result, Result::CLOSED);
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&] {
+            for (int i = 1; i <= kPerProducer; ++i) ASSERT_EQ(channel.add(i), Result::OK);
+        });
+    }
+    for (auto& t : producers) t.join();
+    channel.close();
+    for (auto& t : consumers) t.join();
+
+    EXPECT_EQ(count.load(), kProducers * kPerProducer);
+    EXPECT_EQ(sum.load(), static_cast<long long>(kProducers) * kPerProducer * (kPerProducer + 1) / 2);
+}
+
+TEST(ShardedChannelTest, ProducerOrderHoldsWithinItsShard) {
+    ShardedChannel<int, 4096, 4> channel;
+    constexpr int kProducers = 4;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&channel, p] {
+            ShardedChannel<int, 4096, 4>::set_home(p);
+            for (int i = 0; i < 1000; ++i) channel.add(p * 100000 + i);
+        });
+    }
+    for (auto& t : producers) t.join();
+    channel.close();
+
+    std::vector<int> last(kProducers, -1);
+    while (auto item = channel.get()) {
+        int p = *item / 100000;
+        EXPECT_GT(*item % 100000, last[p]);
+        last[p] = *item % 100000;
+    }
+    for (int p = 0; p < kProducers; ++p) EXPECT_EQ(last[p], 999);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
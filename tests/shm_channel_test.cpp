@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <csignal>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "shm_channel.hpp"
+
+using namespace oska;
+
+struct Sample {
+    uint64_t seq;
+    double value;
+};
+
+TEST(ShmChannelTest, TryAddTryGetMatchChannel) {
+    ShmChannel<int, 2> ch;
+    ASSERT_TRUE(ch.is_open());
+
+    EXPECT_EQ(ch.try_add(1), ChannelBase::Result::OK);
+    EXPECT_EQ(ch.try_add(2), ChannelBase::Result::OK);
+    EXPECT_EQ(ch.try_add(3), ChannelBase::Result::FULL);
+
+    auto first = ch.try_get();
+    ASSERT_TRUE(first);
+    EXPECT_EQ(*first, 1);
+
+    int second = 0;
+    EXPECT_EQ(ch.try_get(second), ChannelBase::Result::OK);
+    EXPECT_EQ(second, 2);
+
+    ChannelBase::Result result = ChannelBase::Result::OK;
+    EXPECT_FALSE(ch.try_get(result));
+    EXPECT_EQ(result, ChannelBase::Result::EMPTY);
+
+    ch.add(4);
+    ch.close();
+    EXPECT_EQ(ch.add(5), ChannelBase::Result::CLOSED);
+    auto last = ch.get();
+    ASSERT_TRUE(last);
+    EXPECT_EQ(*last, 4);
+    EXPECT_FALSE(ch.get(result));
+    EXPECT_EQ(result, ChannelBase::Result::CLOSED);
+}
+
+TEST(ShmChannelTest, NamedSegmentSharedBetweenHandles) {
+    std::string name = "/oska_shm_test_" + std::to_string(::getpid());
+    auto producer = ShmChannel<Sample, 8>::create(name);
+    ASSERT_TRUE(producer->is_open());
+    auto consumer = ShmChannel<Sample, 8>::open(name);
+    ASSERT_TRUE(consumer->is_open());
+    ShmChannel<Sample, 8>::unlink(name);
+
+    EXPECT_FALSE((ShmChannel<Sample, 8>::open(name)->is_open()));
+
+    producer->add(Sample{7, 1.5});
+    Sample out{};
+    EXPECT_EQ(consumer->get(out), ChannelBase::Result::OK);
+    EXPECT_EQ(out.seq, 7u);
+    EXPECT_EQ(out.value, 1.5);
+}
+
+TEST(ShmChannelTest, UnopenedChannelIsInert) {
+    auto ch = ShmChannel<int, 4>::open("/oska_shm_missing_" + std::to_string(::getpid()));
+    ASSERT_FALSE(ch->is_open());
+
+    ch->close();
+    EXPECT_FALSE(ch->attach());
+    EXPECT_FALSE(ch->peer_died());
+    EXPECT_EQ(ch->try_add(1), ChannelBase::Result::CLOSED);
+    int out = 0;
+    EXPECT_EQ(ch->try_get(out), ChannelBase::Result::CLOSED);
+}
+
+TEST(ShmChannelTest, PeerSlotsAreHeldPerProcess) {
+    std::string name = "/oska_shm_peers_" + std::to_string(::getpid());
+    auto ch = ShmChannel<int, shm::kMaxPeers>::create(name);
+    ASSERT_TRUE(ch->is_open());
+    ShmChannel<int, shm::kMaxPeers>::unlink(name);
+
+    // A child that never attached must not take the parent's slot with it.
+    pid_t quitter = ::fork();
+    ASSERT_GE(quitter, 0);
+    if (quitter == 0) {
+        ch.reset();
+        ::_exit(0);
+    }
+    ::waitpid(quitter, nullptr, 0);
+
+    // The parent holds one slot, so exactly one of these children gets none.
+    std::vector<pid_t> children;
+    for (size_t i = 0; i < shm::kMaxPeers; ++i) {
+        pid_t child = ::fork();
+        ASSERT_GE(child, 0);
+        if (child == 0) {
+            ch->add(ch->attach() ? 1 : 0);
+            ::pause();
+            ::_exit(0);
+        }
+        children.push_back(child);
+    }
+
+    int attached = 0;
+    for (size_t i = 0; i < shm::kMaxPeers; ++i) {
+        int ok = 0;
+        ASSERT_EQ(ch->get(ok), ChannelBase::Result::OK);
+        attached += ok;
+    }
+    EXPECT_EQ(attached, static_cast<int>(shm::kMaxPeers) - 1);
+
+    for (pid_t child : children) ::kill(child, SIGKILL);
+    for (pid_t child : children) ::waitpid(child, nullptr, 0);
+}
+
+TEST(ShmChannelTest, ForkedProducerStreamsInOrder) {
+    constexpr uint64_t kCount = 20000;
+    ShmChannel<Sample, 16> ch;
+
+    pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        ch.attach();
+        for (uint64_t i = 0; i < kCount; ++i) {
+            if (ch.add(Sample{i, static_cast<double>(i)}) != ChannelBase::Result::OK) ::_exit(1);
+        }
+        ch.close();
+        ::_exit(0);
+    }
+
+    uint64_t expected = 0;
+    Sample s{};
+    while (ch.get(s) == ChannelBase::Result::OK) {
+        ASSERT_EQ(s.seq, expected);
+        expected++;
+    }
+    EXPECT_EQ(expected, kCount);
+    EXPECT_FALSE(ch.peer_died());
+
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(ShmChannelTest, DeadPeerWakesBlockedConsumer) {
+    ShmChannel<int, 4> ch;
+
+    pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        ch.attach();
+        ch.add(1);
+        ::pause();
+        ::_exit(0);
+    }
+
+    auto first = ch.get();
+    ASSERT_TRUE(first);
+    EXPECT_EQ(*first, 1);
+
+    std::thread killer([child] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ::kill(child, SIGKILL);
+    });
+
+    ChannelBase::Result result = ChannelBase::Result::OK;
+    auto none = ch.get(result);
+    EXPECT_FALSE(none);
+    EXPECT_EQ(result, ChannelBase::Result::CLOSED);
+    EXPECT_TRUE(ch.peer_died());
+    EXPECT_EQ(ch.add(2), ChannelBase::Result::CLOSED);
+
+    killer.join();
+    ::waitpid(child, nullptr, 0);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "channel.hpp"
+#include "oska_epoll_loop.hpp"
+#include "oska_priority_loop.hpp"
+#include "oska_topology.hpp"
+
+using namespace oska;
+
+OSKA_DEFINE_EVENT(EvWhere, int)
+
+TEST(TopologyTest, ParsesCpuLists) {
+    EXPECT_EQ(topo::parse_cpulist("0-3,8,10-11\n"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(topo::parse_cpulist("5"), std::vector<int>{5});
+    EXPECT_TRUE(topo::parse_cpulist("").empty());
+}
+
+TEST(TopologyTest, DetectsAllowedCpus) {
+    auto topology = topo::Topology::detect();
+    ASSERT_FALSE(topology.cpus().empty());
+    EXPECT_FALSE(topology.nodes().empty());
+    for (const auto& cpu : topology.cpus()) {
+        EXPECT_EQ(topology.node_of(cpu.id), cpu.node);
+    }
+    EXPECT_EQ(topology.node_of(-5), -1);
+}
+
+TEST(TopologyTest, OnePerCoreSkipsSiblings) {
+    auto topology = topo::Topology::detect();
+    auto cores = topology.one_per_core();
+    ASSERT_FALSE(cores.empty());
+    EXPECT_LE(cores.size(), topology.cpus().size());
+
+    std::set<std::pair<int, int>> seen;
+    for (const auto& c : cores) {
+        EXPECT_TRUE(seen.insert({c.package, c.core}).second);
+    }
+
+    auto layout = topology.layout(cores.size() + 1);
+    ASSERT_EQ(layout.size(), cores.size() + 1);
+    EXPECT_EQ(layout.front().cpu, cores.front().id);
+    EXPECT_EQ(layout.back().cpu, cores.front().id);   // wraps around
+}
+
+TEST(TopologyTest, SpawnPinsThread) {
+    int cpu = topo::Topology::detect().cpus().back().id;
+    int seen = -1;
+    std::thread t = topo::spawn(Placement{cpu, -1}, [&seen] { seen = ::sched_getcpu(); });
+    t.join();
+    EXPECT_EQ(seen, cpu);
+}
+
+TEST(TopologyTest, NodeAllocatorBacksContainers) {
+    int node = topo::Topology::detect().nodes().front();
+    std::vector<int, topo::NodeAllocator<int>> values{topo::NodeAllocator<int>(node)};
+    values.reserve(10000);
+    for (int i = 0; i < 10000; ++i) values.push_back(i);
+    EXPECT_EQ(values[9999], 9999);
+    EXPECT_EQ(values.get_allocator().node(), node);
+
+    auto channel = topo::make_on_node<Channel<int, 64>>(node);
+    EXPECT_EQ(channel->add(7), ChannelBase::Result::OK);
+    EXPECT_EQ(*channel->get(), 7);
+}
+
+TEST(TopologyTest, LoopsRunOnTheirPlacement) {
+    auto placement = topo::Topology::detect().layout(1).front();
+
+    CormanManager manager;
+    EpollEventLoop loop("placed", manager, placement);
+    std::atomic<int> seen{-1};
+    manager.connect<EvWhere>(&loop, [&](int) { seen = ::sched_getcpu(); });
+    std::thread runner([&] { loop.run(); });
+    manager.gen<EvWhere>(1);
+    while (seen == -1) std::this_thread::yield();
+    loop.stop();
+    runner.join();
+    EXPECT_EQ(seen.load(), placement.cpu);
+
+    PriorityEventLoop::Options options;
+    options.placement = placement;
+    PriorityEventLoop lanes(options, "placed-lanes");
+    int lane_cpu = -1;
+    Corman.connect<EvWhere>(&lanes, [&](int) { lane_cpu = ::sched_getcpu(); });
+    Corman.gen<EvWhere>(2);
+    std::thread drainer([&] { lanes.stop(); lanes.run(); });
+    drainer.join();
+    EXPECT_EQ(lane_cpu, placement.cpu);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
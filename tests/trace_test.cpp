@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <sstream>
+#include "oska_events.hpp"
+#include "channel.hpp"
+
+using namespace oska;
+
+// ---- Traced Event Loop ---- //
+class TracedLoop : public EventLoopInterface {
+public:
+    explicit TracedLoop(const std::string& name) : tracer(name) {}
+
+    void post(size_t tag, void* data) override {
+        queue.add(EventWrapper(tag, data));
+    }
+
+    void post(const EventWrapper& ev) override {
+        queue.add(ev);
+    }
+
+    void connect(size_t tag, Callback cb) override {
+        callbacks[tag] = cb;
+    }
+
+    void run() override {
+        for (auto ev = queue.get(); ev; ev = queue.get()) {
+            auto it = callbacks.find(ev->tag);
+            if (it != callbacks.end()) {
+                trace::HandlerScope scope(tracer, *ev);
+                it->second(ev->data);
+            }
+        }
+    }
+
+    void stop() { queue.close(); }
+
+    trace::LoopTracer tracer;
+
+private:
+    Channel<EventWrapper, 64> queue;
+    std::unordered_map<size_t, Callback> callbacks;
+};
+
+OSKA_DEFINE_EVENT(EvTraceFast, int)
+OSKA_DEFINE_EVENT(EvTraceSlow)
+
+TEST(TraceHistogram, PercentilesWithinBucketPrecision) {
+    trace::Histogram h;
+    for (uint64_t v = 1; v <= 1000; ++v) h.record(v);
+
+    EXPECT_EQ(h.count(), 1000u);
+    EXPECT_EQ(h.max(), 1000u);
+    EXPECT_NEAR(static_cast<double>(h.percentile(50)), 500.0, 500.0 * 0.07);
+    EXPECT_NEAR(static_cast<double>(h.percentile(99)), 990.0, 990.0 * 0.07);
+    EXPECT_EQ(h.percentile(100), 1000u);
+}
+
+TEST(TraceHistogram, DrainIntoKeepsConcurrentSamples) {
+    trace::Histogram h;
+    trace::Histogram drained;
+    constexpr uint64_t kSamples = 200000;
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (uint64_t v = 1; v <= kSamples; ++v) h.record(v);
+        done.store(true, std::memory_order_release);
+    });
+    while (!done.load(std::memory_order_acquire)) h.drain_into(drained);
+    writer.join();
+    h.drain_into(drained);
+
+    EXPECT_EQ(h.count(), 0u);
+    EXPECT_EQ(h.max(), 0u);
+    EXPECT_EQ(drained.count(), kSamples);
+    EXPECT_EQ(drained.max(), kSamples);
+    EXPECT_EQ(drained.percentile(100), kSamples);
+}
+
+TEST(TraceHistogram, BucketBoundsCoverValue) {
+    for (uint64_t v : {0ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull, ~0ull}) {
+        size_t i = trace::Histogram::index_of(v);
+        ASSERT_LT(i, trace::Histogram::kBuckets);
+        EXPECT_GE(trace::Histogram::upper_bound_of(i), v);
+    }
+}
+
+TEST(TraceLoop, RecordsPerEventAndSlowHandlers) {
+    TracedLoop loop("traced");
+    std::atomic<int> slow_reports{0};
+    loop.tracer.set_slow_handler(std::chrono::milliseconds(2),
+        [&](const std::string& name, size_t, uint64_t ns) {
+            EXPECT_EQ(name, "traced");
+            EXPECT_GE(ns, 2000000u);
+            slow_reports++;
+        });
+
+    std::atomic<int> handled{0};
+    Corman.connect<EvTraceFast>(&loop, [&](int) { handled++; });
+    Corman.connect<EvTraceSlow>(&loop, [&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        handled++;
+    });
+
+    std::thread runner([&] { loop.run(); });
+
+    for (int i = 0; i < 100; ++i) Corman.gen<EvTraceFast>(i);
+    Corman.gen<EvTraceSlow>();
+
+    while (handled < 101) std::this_thread::yield();
+    loop.stop();
+    runner.join();
+
+    auto* fast = loop.tracer.stats(TypeId<EvTraceFast>::value());
+    auto* slow = loop.tracer.stats(TypeId<EvTraceSlow>::value());
+    ASSERT_TRUE(fast);
+    ASSERT_TRUE(slow);
+    EXPECT_EQ(fast->handler.count(), 100u);
+    EXPECT_EQ(fast->queue.count(), 100u);
+    EXPECT_EQ(fast->dispatch.count(), 100u);
+    EXPECT_EQ(slow->slow.load(), 1u);
+    EXPECT_EQ(slow_reports.load(), 1);
+    EXPECT_EQ(loop.tracer.total().handler.count(), 101u);
+
+    std::ostringstream os;
+    trace::Registry::instance().dump(os, true);
+    EXPECT_NE(os.str().find("loop=traced event=EvTraceFast count=100"), std::string::npos);
+    EXPECT_NE(os.str().find("event=EvTraceSlow count=1 "), std::string::npos);
+    EXPECT_EQ(fast->handler.count(), 0u);
+}
+
+TEST(TraceLoop, PeriodicDumpWritesToSink) {
+    std::atomic<int> dumps{0};
+    {
+        trace::PeriodicDump dump(std::chrono::milliseconds(5), [&](const std::string&) { dumps++; });
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    }
+    EXPECT_GT(dumps.load(), 0);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}